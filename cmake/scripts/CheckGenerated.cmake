@@ -0,0 +1,44 @@
+cmake_policy(PUSH)
+cmake_policy(SET CMP0007 NEW)
+
+if(NOT DEFINED SOURCE_FILE OR NOT DEFINED OUTPUT_FILE OR NOT DEFINED COMMAND)
+  message(FATAL_ERROR "Usage: cmake -DSOURCE_FILE=... -DOUTPUT_FILE=... -DCOMMAND=\"cmd args\" -P CheckGenerated.cmake")
+endif()
+
+# Run the command, which should write the generated code to OUTPUT_FILE
+separate_arguments(COMMAND_LIST UNIX_COMMAND "${COMMAND}")
+set(ENV{SOURCE_DATE_EPOCH} 0)
+execute_process(COMMAND ${COMMAND_LIST}
+  RESULT_VARIABLE run_result
+)
+if(NOT run_result EQUAL 0)
+  message(FATAL_ERROR "Command failed (${run_result}): ${COMMAND}")
+endif()
+
+file(READ "${OUTPUT_FILE}" output)
+
+# The generated code must match the regular expression on every
+# "// CHECK: regex" line in the source file, and must not match the one on any
+# "// CHECK-NOT: regex" line.  The lines are read as a CMake list, so they
+# can't contain a semicolon.
+file(STRINGS "${SOURCE_FILE}" check_lines REGEX "//[ \t]*CHECK(-NOT)?:")
+set(failed FALSE)
+foreach(line IN LISTS check_lines)
+  string(REGEX MATCH "//[ \t]*CHECK(-NOT)?:[ \t]*(.+)$" _ "${line}")
+  set(negate "${CMAKE_MATCH_1}")
+  set(regex "${CMAKE_MATCH_2}")
+  string(REGEX MATCH "${regex}" found "${output}")
+  if(negate AND found)
+    message("Unexpected match in ${OUTPUT_FILE}: ${regex}")
+    set(failed TRUE)
+  elseif(NOT negate AND NOT found)
+    message("No match in ${OUTPUT_FILE}: ${regex}")
+    set(failed TRUE)
+  endif()
+endforeach()
+
+if(failed)
+  message(FATAL_ERROR "Test failed: ${OUTPUT_FILE} does not match the checks in ${SOURCE_FILE}")
+endif()
+
+cmake_policy(POP)
@@ -217,6 +217,20 @@ endif()
 
 set(_PREV_WANT_PYTHON_VERSION "${WANT_PYTHON_VERSION}" CACHE INTERNAL "Internal." FORCE)
 
+cmake_dependent_option(BUILD_INTERROGATE_RUNTIME
+  "Do you want to build the Python support code as a shared
+interrogate_runtime library?  Modules generated with -runtime-library
+link against it instead of each carrying their own copy.  This needs
+INTERROGATE_RUNTIME_INCLUDE_DIRS to point at the headers of the library
+being wrapped (register_type.h and so on), and
+INTERROGATE_RUNTIME_LIBRARIES at the libraries that define the symbols
+declared there." OFF "HAVE_PYTHON" OFF)
+
+set(INTERROGATE_RUNTIME_INCLUDE_DIRS ""
+  CACHE STRING "Include directories needed to compile interrogate_runtime.")
+set(INTERROGATE_RUNTIME_LIBRARIES ""
+  CACHE STRING "Libraries that interrogate_runtime needs to link against.")
+
 
 # How to invoke bison and flex.  Panda takes advantage of some
 # bison/flex features, and therefore specifically requires bison and
@@ -27,6 +27,16 @@ check_include_file_cxx(utime.h PHAVE_UTIME_H)
 check_include_file_cxx(glob.h PHAVE_GLOB_H)
 check_include_file_cxx(dirent.h PHAVE_DIRENT_H)
 
+# Can we use threads?  Module databases are then loaded on several threads at
+# once.
+if(NOT EMSCRIPTEN AND NOT WASI)
+  set(THREADS_PREFER_PTHREAD_FLAG ON)
+  find_package(Threads QUIET)
+  set(HAVE_THREADS ${Threads_FOUND})
+else()
+  set(HAVE_THREADS OFF)
+endif()
+
 # Set LINK_ALL_STATIC if we're building everything as static libraries.
 # Also set the library type used for "modules" appropriately.
 if(BUILD_SHARED_LIBS)
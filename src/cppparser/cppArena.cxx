@@ -0,0 +1,214 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cppArena.cxx
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#include "cppArena.h"
+
+#include <new>
+
+// The size of the blocks that are requested from the heap.  Allocations that
+// are larger than a quarter of this get a block of their own.
+static const size_t block_size = 64 * 1024;
+
+// Every node is preceded by a header that records the arena it came from (or
+// nullptr if it came from the heap), so that free_node() knows what to do
+// with it, and the function that runs its destructor, which is cleared once
+// the node has been deleted.  The header is padded to keep the node maximally
+// aligned.
+class NodeHeader {
+public:
+  CPPArena *_arena;
+  void (*_destroy)(void *ptr);
+};
+static const size_t node_align = alignof(std::max_align_t);
+static const size_t header_size =
+  (sizeof(NodeHeader) + node_align - 1) & ~(node_align - 1);
+
+CPPArena *CPPArena::_current = nullptr;
+
+/**
+ *
+ */
+CPPArena::
+CPPArena() :
+  _next(nullptr),
+  _end(nullptr),
+  _num_bytes(0)
+{
+}
+
+/**
+ * Destroys all of the nodes allocated from this arena that have not yet been
+ * deleted, in the reverse order of their creation, and then releases all of
+ * the memory in one go.  The caller must ensure that none of the nodes are
+ * still in use; the release callbacks are given a chance to forget about them
+ * first.
+ */
+CPPArena::
+~CPPArena() {
+  if (_current == this) {
+    _current = nullptr;
+  }
+
+  ReleaseCallbacks &callbacks = get_release_callbacks();
+  for (ReleaseCallbacks::iterator ci = callbacks.begin();
+       ci != callbacks.end();
+       ++ci) {
+    (*ci)(this);
+  }
+
+  for (Nodes::reverse_iterator ni = _nodes.rbegin(); ni != _nodes.rend(); ++ni) {
+    NodeHeader *header = (NodeHeader *)((char *)(*ni) - header_size);
+    if (header->_destroy != nullptr) {
+      header->_destroy(*ni);
+    }
+  }
+
+  for (Blocks::iterator bi = _blocks.begin(); bi != _blocks.end(); ++bi) {
+    ::operator delete(*bi);
+  }
+}
+
+/**
+ * Returns a pointer to a maximally-aligned block of memory of at least the
+ * indicated size.  The memory remains valid until the arena is destroyed.
+ */
+void *CPPArena::
+allocate(size_t size) {
+  size = (size + node_align - 1) & ~(node_align - 1);
+  _num_bytes += size;
+
+  if (size > block_size / 4) {
+    // Too big to share a block with other nodes; give it its own, and keep
+    // allocating from the current block afterwards.
+    char *block = (char *)::operator new(size);
+    _blocks.push_back(block);
+    return block;
+  }
+
+  if ((size_t)(_end - _next) < size) {
+    _next = (char *)::operator new(block_size);
+    _end = _next + block_size;
+    _blocks.push_back(_next);
+  }
+
+  void *ptr = _next;
+  _next += size;
+  return ptr;
+}
+
+/**
+ * Returns the total number of bytes that have been allocated from this arena.
+ */
+size_t CPPArena::
+get_num_bytes() const {
+  return _num_bytes;
+}
+
+/**
+ * Makes this the arena from which new nodes will be allocated.  Returns the
+ * arena that was previously current, which may be nullptr.
+ */
+CPPArena *CPPArena::
+make_current() {
+  CPPArena *prev = _current;
+  _current = this;
+  return prev;
+}
+
+/**
+ * Returns the arena from which new nodes are currently being allocated, or
+ * nullptr if they are being allocated from the heap.
+ */
+CPPArena *CPPArena::
+get_current() {
+  return _current;
+}
+
+/**
+ * Changes the arena from which new nodes will be allocated.  Passing nullptr
+ * means that they will be allocated from the heap.
+ */
+void CPPArena::
+set_current(CPPArena *arena) {
+  _current = arena;
+}
+
+/**
+ * Allocates the memory for a new parser node, recording the function that
+ * runs its destructor if the arena is destroyed before the node is deleted.
+ */
+void *CPPArena::
+alloc_node(size_t size, DestroyFunc *destroy) {
+  char *ptr;
+  if (_current != nullptr) {
+    ptr = (char *)_current->allocate(header_size + size) + header_size;
+    if (destroy != nullptr) {
+      _current->_nodes.push_back(ptr);
+    }
+  } else {
+    ptr = (char *)::operator new(header_size + size) + header_size;
+  }
+  NodeHeader *header = (NodeHeader *)(ptr - header_size);
+  header->_arena = _current;
+  header->_destroy = destroy;
+  return ptr;
+}
+
+/**
+ * Frees the memory for a parser node that was allocated with alloc_node(),
+ * after its destructor has run.  Nodes that were allocated from an arena are
+ * not actually freed until the arena itself is destroyed.
+ */
+void CPPArena::
+free_node(void *ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  NodeHeader *header = (NodeHeader *)((char *)ptr - header_size);
+  if (header->_arena == nullptr) {
+    ::operator delete(header);
+  } else {
+    header->_destroy = nullptr;
+  }
+}
+
+/**
+ * Returns the arena from which the indicated node was allocated with
+ * alloc_node(), or nullptr if it was allocated from the heap.
+ */
+CPPArena *CPPArena::
+get_node_arena(const void *ptr) {
+  const NodeHeader *header =
+    (const NodeHeader *)((const char *)ptr - header_size);
+  return header->_arena;
+}
+
+/**
+ * Registers a function that is called whenever an arena is about to be
+ * destroyed, so that anything caching pointers to its nodes can forget them.
+ */
+void CPPArena::
+add_release_callback(ReleaseCallback *callback) {
+  get_release_callbacks().push_back(callback);
+}
+
+/**
+ * Returns the list of functions registered with add_release_callback().  This
+ * is constructed on first use and never destroyed, since a global parser may
+ * release its arena during static destruction.
+ */
+CPPArena::ReleaseCallbacks &CPPArena::
+get_release_callbacks() {
+  static ReleaseCallbacks *callbacks = new ReleaseCallbacks;
+  return *callbacks;
+}
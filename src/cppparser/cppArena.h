@@ -0,0 +1,103 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cppArena.h
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#ifndef CPPARENA_H
+#define CPPARENA_H
+
+//#include "dtoolbase.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * A simple bump-pointer allocator for the nodes created by the parser.  The
+ * parser creates a great many small objects that are almost never freed, so
+ * rather than going through the general-purpose heap for each one, they are
+ * carved out of large blocks that are released all at once when the arena is
+ * destroyed.  The destructors of the nodes that are still alive at that point
+ * are run first, so that the memory they own is freed as well.
+ *
+ * Nodes are allocated from whichever arena is current at the time; see
+ * make_current().  When there is no current arena, they come from the heap.
+ */
+class CPPArena {
+public:
+  CPPArena();
+  ~CPPArena();
+
+  void *allocate(size_t size);
+  size_t get_num_bytes() const;
+
+  CPPArena *make_current();
+  static CPPArena *get_current();
+  static void set_current(CPPArena *arena);
+
+  template<class Type>
+  inline static void *alloc_node(size_t size);
+  static void free_node(void *ptr);
+  static CPPArena *get_node_arena(const void *ptr);
+
+  typedef void ReleaseCallback(CPPArena *arena);
+  static void add_release_callback(ReleaseCallback *callback);
+
+private:
+  CPPArena(const CPPArena &copy) = delete;
+  CPPArena &operator = (const CPPArena &copy) = delete;
+
+  typedef void DestroyFunc(void *ptr);
+  static void *alloc_node(size_t size, DestroyFunc *destroy);
+
+  template<class Type>
+  static void destroy_node(void *ptr);
+
+  typedef std::vector<ReleaseCallback *> ReleaseCallbacks;
+  static ReleaseCallbacks &get_release_callbacks();
+
+  typedef std::vector<char *> Blocks;
+  Blocks _blocks;
+  char *_next;
+  char *_end;
+  size_t _num_bytes;
+
+  // The nodes allocated from this arena that have a destructor to run.
+  typedef std::vector<void *> Nodes;
+  Nodes _nodes;
+
+  static CPPArena *_current;
+};
+
+/**
+ * Allocates the memory for a new parser node of the indicated class, or of a
+ * class derived from it.  This is used to implement operator new for the
+ * node classes; the class must have a virtual destructor if it has derived
+ * classes.
+ */
+template<class Type>
+inline void *CPPArena::
+alloc_node(size_t size) {
+  return alloc_node(size, std::is_trivially_destructible<Type>::value
+                          ? nullptr : &destroy_node<Type>);
+}
+
+/**
+ * Runs the destructor of a node of the indicated class that is still alive
+ * when its arena is destroyed.
+ */
+template<class Type>
+void CPPArena::
+destroy_node(void *ptr) {
+  ((Type *)ptr)->~Type();
+}
+
+#endif
@@ -281,3 +281,14 @@ is_less(const CPPDeclaration *other) const {
   }
   return false;
 }
+
+/**
+ * Hashes the element type's subtype and whether the array has bounds.
+ */
+size_t CPPArrayType::
+compute_hash() const {
+  // The bounds and element type are compared by value in is_less(), so we can
+  // only hash the properties that equal values are sure to have in common.
+  size_t hash = combine_hash((size_t)get_subtype(), (_bounds != nullptr));
+  return combine_hash(hash, (size_t)_element_type->get_subtype());
+}
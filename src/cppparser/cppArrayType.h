@@ -62,6 +62,7 @@ public:
 protected:
   virtual bool is_equal(const CPPDeclaration *other) const;
   virtual bool is_less(const CPPDeclaration *other) const;
+  virtual size_t compute_hash() const;
 };
 
 #endif
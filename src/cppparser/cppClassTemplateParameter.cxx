@@ -124,3 +124,19 @@ is_less(const CPPDeclaration *other) const {
 
   return *_ident < *ot->_ident;
 }
+
+/**
+ * Hashes the default type, the pack flag and the parameter name.
+ */
+size_t CPPClassTemplateParameter::
+compute_hash() const {
+  size_t hash = combine_hash((size_t)get_subtype(),
+                             std::hash<const void *>()(_default_type));
+  hash = combine_hash(hash, (size_t)_packed);
+  if (_ident != nullptr) {
+    for (const CPPNameComponent &name : _ident->_names) {
+      hash = combine_hash(hash, std::hash<std::string>()(name.get_name()));
+    }
+  }
+  return hash;
+}
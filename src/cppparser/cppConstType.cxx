@@ -249,3 +249,12 @@ is_less(const CPPDeclaration *other) const {
 
   return _wrapped_around < ot->_wrapped_around;
 }
+
+/**
+ * Hashes the type being made const.
+ */
+size_t CPPConstType::
+compute_hash() const {
+  return combine_hash((size_t)get_subtype(),
+                      std::hash<const void *>()(_wrapped_around));
+}
@@ -20,6 +20,7 @@
 #include "cppFile.h"
 #include "cppCommentBlock.h"
 #include "cppAttributeList.h"
+#include "cppArena.h"
 
 #include <string>
 #include <vector>
@@ -98,6 +99,9 @@ public:
   CPPDeclaration(const CPPDeclaration &copy);
   virtual ~CPPDeclaration() {};
 
+  inline void *operator new(size_t size) { return CPPArena::alloc_node<CPPDeclaration>(size); }
+  inline void operator delete(void *ptr) { CPPArena::free_node(ptr); }
+
   CPPDeclaration &operator = (const CPPDeclaration &copy);
 
   bool operator == (const CPPDeclaration &other) const;
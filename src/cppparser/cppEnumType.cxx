@@ -73,13 +73,7 @@ get_underlying_type() {
   if (_element_type == nullptr) {
     // This enum is untyped.  Use a suitable default, ie.  'int'. In the
     // future, we might want to check whether it fits in an int.
-    static CPPType *default_element_type = nullptr;
-    if (default_element_type == nullptr) {
-      default_element_type =
-        CPPType::new_type(new CPPConstType(new CPPSimpleType(CPPSimpleType::T_int, 0)));
-    }
-
-    return default_element_type;
+    return CPPType::new_type(new CPPConstType(new CPPSimpleType(CPPSimpleType::T_int, 0)));
   } else {
     // This enum has an explicit type, so use that.
     return CPPType::new_type(new CPPConstType(_element_type));
@@ -111,8 +105,8 @@ add_element(const std::string &name, CPPExpression *value,
   if (value == nullptr) {
     if (_last_value == nullptr) {
       // This is the first value, and should therefore be 0.
-      static CPPExpression *const zero = new CPPExpression(0);
-      value = zero;
+      static CPPExpression zero(0);
+      value = &zero;
 
     } else if (_last_value->_type == CPPExpression::T_integer) {
       value = new CPPExpression(_last_value->_u._integer + 1);
@@ -128,8 +122,8 @@ add_element(const std::string &name, CPPExpression *value,
     } else {
       // We may not be able to determine the value just yet.  No problem;
       // we'll just define it as another expression.
-      static CPPExpression *const one = new CPPExpression(1);
-      value = new CPPExpression('+', _last_value, one);
+      static CPPExpression one(1);
+      value = new CPPExpression('+', _last_value, &one);
     }
   }
   inst->_initializer = value;
@@ -54,6 +54,11 @@ public:
   Filename _filename_as_referenced;
   mutable Source _source;
   mutable bool _pragma_once;
+
+  // If the entire file is wrapped in an #ifndef block, this is the macro
+  // controlling it, so that we can avoid reading the file again while it
+  // remains defined.
+  mutable std::string _include_guard;
 };
 
 inline std::ostream &operator << (std::ostream &out, const CPPFile &file) {
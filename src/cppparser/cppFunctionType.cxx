@@ -461,3 +461,18 @@ is_less(const CPPDeclaration *other) const {
   }
   return *_parameters < *ot->_parameters;
 }
+
+/**
+ * Hashes the return type, the flags and the shape of the parameter list.
+ */
+size_t CPPFunctionType::
+compute_hash() const {
+  size_t hash = combine_hash((size_t)get_subtype(),
+                             std::hash<const void *>()(_return_type));
+  hash = combine_hash(hash, (size_t)_flags);
+  if (_parameters != nullptr) {
+    hash = combine_hash(hash, (size_t)_parameters->_includes_ellipsis);
+    hash = combine_hash(hash, _parameters->_parameters.size());
+  }
+  return hash;
+}
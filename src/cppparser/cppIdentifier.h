@@ -38,6 +38,9 @@ public:
   CPPIdentifier(const CPPNameComponent &name, const CPPFile &file = CPPFile());
   CPPIdentifier(const std::string &name, const cppyyltype &loc);
   CPPIdentifier(const CPPNameComponent &name, const cppyyltype &loc);
+
+  inline void *operator new(size_t size) { return CPPArena::alloc_node<CPPIdentifier>(size); }
+  inline void operator delete(void *ptr) { CPPArena::free_node(ptr); }
   void add_name(const std::string &name);
   void add_name(const CPPNameComponent &name);
 
@@ -16,6 +16,7 @@
 
 //#include "dtoolbase.h"
 #include "cppAttributeList.h"
+#include "cppArena.h"
 
 #include <vector>
 #include <string>
@@ -52,6 +53,9 @@ public:
   CPPInstanceIdentifier(CPPIdentifier *ident);
   CPPInstanceIdentifier(CPPIdentifier *ident, CPPAttributeList attributes);
 
+  inline void *operator new(size_t size) { return CPPArena::alloc_node<CPPInstanceIdentifier>(size); }
+  inline void operator delete(void *ptr) { CPPArena::free_node(ptr); }
+
   CPPType *unroll_type(CPPType *start_type);
 
   void add_modifier(CPPInstanceIdentifierType type,
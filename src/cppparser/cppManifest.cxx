@@ -80,10 +80,12 @@ operator ==(const ExpansionNode &other) const {
 CPPManifest::
 CPPManifest(const CPPPreprocessor &parser, const string &args, const cppyyltype &loc) :
   _parser(parser),
+  _definition(args),
   _variadic_param(-1),
   _loc(loc),
   _expr(nullptr),
-  _vis(V_public)
+  _vis(V_public),
+  _token_state(TS_unknown)
 {
   assert(!args.empty());
   assert(!isspace(args[0]));
@@ -125,9 +127,11 @@ CPPManifest(const CPPPreprocessor &parser, const string &args, const cppyyltype
 CPPManifest::
 CPPManifest(const CPPPreprocessor &parser, const string &macro, const string &definition) :
   _parser(parser),
+  _definition(macro + " " + definition),
   _variadic_param(-1),
   _expr(nullptr),
-  _vis(V_public)
+  _vis(V_public),
+  _token_state(TS_unknown)
 {
   _loc.first_line = 0;
   _loc.first_column = 0;
@@ -341,6 +345,22 @@ determine_type() const {
   return nullptr;
 }
 
+/**
+ * Returns true if the expansion refers to the parameters only in a way that
+ * allows the tokens of the arguments to be substituted for them, ie. without
+ * stringifying or pasting them, and without __VA_OPT__.
+ */
+bool CPPManifest::
+can_substitute_tokens() const {
+  for (const ExpansionNode &node : _expansion) {
+    if (node._stringify || node._paste || !node._nested.empty() ||
+        (node._parm_number >= 0 && !node._expand)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 /**
  * Returns true if the macro definitions are equal.
  */
@@ -19,6 +19,7 @@
 #include "cppFile.h"
 #include "cppVisibility.h"
 #include "cppBisonDefs.h"
+#include "cppToken.h"
 
 #include "vector_string.h"
 #include <unordered_set>
@@ -45,12 +46,17 @@ public:
 
 
   CPPType *determine_type() const;
+  bool can_substitute_tokens() const;
 
   bool is_equal(const CPPManifest *other) const;
   void output(std::ostream &out) const;
 
   const CPPPreprocessor &_parser;
   std::string _name;
+
+  // The text of the definition, in the form accepted by the first
+  // constructor, ie. the name and parameter list followed by the expansion.
+  std::string _definition;
   bool _has_parameters;
   size_t _num_parameters;
   int _variadic_param;
@@ -62,6 +68,21 @@ public:
   // and __end_publish will have a visibility of V_published.
   CPPVisibility _vis;
 
+  // The preprocessor lexes the expansion into tokens the first time the
+  // manifest is expanded, and thereafter replays these tokens instead of
+  // lexing the expansion again.  For a manifest with parameters,
+  // _token_params holds, for each token, the parameter whose argument is to
+  // be substituted for it, or -1.  Some expansions can't be represented this
+  // way, which is indicated by TS_uncacheable.
+  enum TokenState {
+    TS_unknown,
+    TS_cached,
+    TS_uncacheable,
+  };
+  mutable TokenState _token_state;
+  mutable std::vector<CPPToken> _tokens;
+  mutable std::vector<int> _token_params;
+
 private:
   class ExpansionNode {
   public:
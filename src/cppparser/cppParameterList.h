@@ -30,6 +30,9 @@ class CPPParameterList {
 public:
   CPPParameterList();
 
+  inline void *operator new(size_t size) { return CPPArena::alloc_node<CPPParameterList>(size); }
+  inline void operator delete(void *ptr) { CPPArena::free_node(ptr); }
+
   bool is_equivalent(const CPPParameterList &other) const;
 
   bool operator == (const CPPParameterList &other) const;
@@ -16,6 +16,8 @@
 #include "cppTypeParser.h"
 #include "cppBisonDefs.h"
 
+#include <fstream>
+#include <map>
 #include <set>
 #include <assert.h>
 
@@ -26,6 +28,36 @@ bool cppparser_output_class_keyword = false;
  */
 CPPParser::
 CPPParser() : CPPScope(nullptr, CPPNameComponent(""), V_public) {
+  _snapshot = nullptr;
+
+  // A few types are cached in static variables for the lifetime of the
+  // process.  Make sure that these have been created on the heap before the
+  // arena is made current, so that they don't go away with this parser.
+  _prev_arena = CPPArena::get_current();
+  CPPArena::set_current(nullptr);
+  CPPExpression(0).determine_type();
+
+  // All of the nodes created during the lifetime of this parser are
+  // allocated from this arena, and released together when the parser is
+  // destroyed.
+  _arena = new CPPArena;
+  CPPArena::set_current(_arena);
+}
+
+/**
+ * Releases all of the nodes that were created while this parser existed.
+ * Parsers that exist at the same time must be destroyed in the reverse order
+ * in which they were created, and none of the declarations, types or
+ * expressions they returned may be used afterwards.
+ */
+CPPParser::
+~CPPParser() {
+  if (CPPArena::get_current() == _arena) {
+    CPPArena::set_current(_prev_arena);
+  }
+  CPPType::release_types(_arena);
+  delete _arena;
+  delete _snapshot;
 }
 
 /**
@@ -58,12 +90,138 @@ parse_file(const Filename &filename) {
     return true;
   }
 
+  // If another parser was created after this one, don't allocate our nodes
+  // from its arena.
+  CPPArena *prev_arena = _arena->make_current();
+
   if (!init_cpp(file)) {
     std::cerr << "Unable to read " << filename << "\n";
+    CPPArena::set_current(prev_arena);
     return false;
   }
+
+  if (_snapshot != nullptr) {
+    _snapshot->_streams.push_back(CPPSnapshot::Stream());
+    _record_stream = &_snapshot->_streams.back();
+  }
+
   parse_cpp(this);
+  _record_stream = nullptr;
 
+  CPPArena::set_current(prev_arena);
+  return get_error_count() == 0;
+}
+
+/**
+ * Indicates that the files subsequently passed to parse_file() should be
+ * recorded, so that the resulting state can be saved with write_snapshot().
+ */
+void CPPParser::
+record_snapshot() {
+  if (_snapshot == nullptr) {
+    _snapshot = new CPPSnapshot;
+  }
+}
+
+/**
+ * Writes the state after the files parsed since record_snapshot() was called
+ * to the indicated file, so that a later run can load it with read_snapshot()
+ * instead of parsing these files again.  Returns true on success.
+ */
+bool CPPParser::
+write_snapshot(const Filename &filename) const {
+  if (_snapshot == nullptr) {
+    return false;
+  }
+
+  // Fill in the files we read and the macros that remain defined.  Macros
+  // that were not defined in a file were predefined by the caller, who will
+  // do so again in the run that reads the snapshot.
+  CPPSnapshot snapshot(*_snapshot);
+  snapshot._parsed_files.assign(_parsed_files.begin(), _parsed_files.end());
+
+  std::map<std::string, const CPPManifest *> manifests;
+  for (const auto &item : _manifests) {
+    if (!item.second->_loc.file.empty()) {
+      manifests[item.first] = item.second;
+    }
+  }
+  for (const auto &item : manifests) {
+    CPPSnapshot::Manifest def;
+    def._definition = item.second->_definition;
+    def._loc = item.second->_loc;
+    def._vis = item.second->_vis;
+    snapshot._manifests.push_back(std::move(def));
+  }
+
+  Filename snapshot_filename(filename);
+  snapshot_filename.set_binary();
+  std::ofstream out;
+  if (!snapshot_filename.open_write(out)) {
+    std::cerr << "Unable to write " << filename << "\n";
+    return false;
+  }
+  if (!snapshot.write(out, _explicit_files)) {
+    std::cerr << "Unable to write snapshot to " << filename << "\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Loads the state saved by write_snapshot() in a previous run, as though the
+ * files parsed in that run had been parsed again now.  This should be called
+ * after _explicit_files has been filled in, but before any other files are
+ * parsed.  Returns true on success.
+ */
+bool CPPParser::
+read_snapshot(const Filename &filename) {
+  Filename snapshot_filename(filename);
+  snapshot_filename.set_binary();
+  std::ifstream in;
+  if (!snapshot_filename.open_read(in)) {
+    std::cerr << "Unable to read " << filename << "\n";
+    return false;
+  }
+
+  CPPSnapshot snapshot;
+  if (!snapshot.read(in, _explicit_files)) {
+    std::cerr << filename << " is not a valid snapshot file\n";
+    return false;
+  }
+
+  CPPArena *prev_arena = _arena->make_current();
+
+  // Replay the tokens of each file through the parser.
+  for (const CPPSnapshot::Stream &stream : snapshot._streams) {
+    init_snapshot_stream(stream);
+    parse_cpp(this);
+  }
+
+  for (const CPPFile &file : snapshot._parsed_files) {
+    std::pair<ParsedFiles::iterator, bool> result = _parsed_files.insert(file);
+    if (!result.second) {
+      const CPPFile &other = *result.first;
+      other._pragma_once = other._pragma_once || file._pragma_once;
+      if (other._include_guard.empty()) {
+        other._include_guard = file._include_guard;
+      }
+    }
+  }
+
+  for (const CPPSnapshot::Manifest &def : snapshot._manifests) {
+    CPPManifest *manifest = new CPPManifest(*this, def._definition, def._loc);
+    manifest->_vis = def._vis;
+    if (!manifest->_has_parameters) {
+      std::string expr_string = manifest->expand();
+      if (!expr_string.empty()) {
+        manifest->_expr = CPPPreprocessor::parse_expr(expr_string, this, this, def._loc);
+      }
+    }
+    _manifests[manifest->_name] = manifest;
+  }
+
+  CPPArena::set_current(prev_arena);
   return get_error_count() == 0;
 }
 
@@ -74,7 +232,10 @@ parse_file(const Filename &filename) {
 CPPExpression *CPPParser::
 parse_expr(const std::string &expr) {
   YYLTYPE loc = {};
-  return CPPPreprocessor::parse_expr(expr, this, this, loc);
+  CPPArena *prev_arena = _arena->make_current();
+  CPPExpression *result = CPPPreprocessor::parse_expr(expr, this, this, loc);
+  CPPArena::set_current(prev_arena);
+  return result;
 }
 
 /**
@@ -83,11 +244,10 @@ parse_expr(const std::string &expr) {
  */
 CPPType *CPPParser::
 parse_type(const std::string &type) {
+  CPPArena *prev_arena = _arena->make_current();
   CPPTypeParser ep(this, this);
   ep._verbose = 0;
-  if (ep.parse_type(type, *this)) {
-    return ep._type;
-  } else {
-    return nullptr;
-  }
+  bool okflag = ep.parse_type(type, *this);
+  CPPArena::set_current(prev_arena);
+  return okflag ? ep._type : nullptr;
 }
@@ -28,13 +28,23 @@
 class CPPParser : public CPPScope, public CPPPreprocessor {
 public:
   CPPParser();
+  ~CPPParser();
 
   virtual bool is_fully_specified() const;
 
   bool parse_file(const Filename &filename);
 
+  void record_snapshot();
+  bool write_snapshot(const Filename &filename) const;
+  bool read_snapshot(const Filename &filename);
+
   CPPExpression *parse_expr(const std::string &expr);
   CPPType *parse_type(const std::string &type);
+
+private:
+  CPPSnapshot *_snapshot;
+  CPPArena *_arena;
+  CPPArena *_prev_arena;
 };
 
 /*
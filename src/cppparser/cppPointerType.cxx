@@ -306,3 +306,12 @@ is_less(const CPPDeclaration *other) const {
 
   return _pointing_at < ot->_pointing_at;
 }
+
+/**
+ * Hashes the type being pointed to.
+ */
+size_t CPPPointerType::
+compute_hash() const {
+  return combine_hash((size_t)get_subtype(),
+                      std::hash<const void *>()(_pointing_at));
+}
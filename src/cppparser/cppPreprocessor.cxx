@@ -32,8 +32,10 @@
 #include "pstrtod.h"
 #include "string_utils.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <ctype.h>
+#include <iterator>
 #include <set>
 
 using std::cerr;
@@ -220,7 +222,8 @@ trim_blanks(const string &str) {
  */
 CPPPreprocessor::InputFile::
 InputFile() {
-  _in = nullptr;
+  _ptr = nullptr;
+  _end = nullptr;
   _manifest = nullptr;
   _line_number = 0;
   _col_number = 0;
@@ -228,6 +231,14 @@ InputFile() {
   _next_col_number = 1;
   _lock_position = false;
   _ignore_manifest = false;
+  _guard_state = GS_none;
+  _if_depth = 0;
+  _tokens = nullptr;
+  _next_token = 0;
+  _token_params = nullptr;
+  _argument = false;
+  _comments = nullptr;
+  _next_comment = 0;
 }
 
 /**
@@ -235,23 +246,45 @@ InputFile() {
  */
 CPPPreprocessor::InputFile::
 ~InputFile() {
-  if (_in != nullptr) {
-    delete _in;
-  }
 }
 
 /**
- *
+ * Reads the entire contents of the indicated file into memory, so that
+ * characters can subsequently be handed out without going through the
+ * stream machinery.
  */
 bool CPPPreprocessor::InputFile::
 open(const CPPFile &file) {
-  assert(_in == nullptr);
+  assert(_ptr == nullptr);
 
   _file = file;
-  std::ifstream *in = new std::ifstream;
-  _in = in;
+  std::ifstream in;
+  if (!_file._filename.open_read(in)) {
+    return false;
+  }
 
-  return _file._filename.open_read(*in);
+  in.seekg(0, std::ios::end);
+  std::streamoff size = in.tellg();
+  if (size > 0) {
+    in.seekg(0, std::ios::beg);
+    _input.resize((size_t)size);
+    in.read(&_input[0], size);
+    _input.resize((size_t)in.gcount());
+  } else {
+    // Not a seekable stream, or an empty file.
+    in.clear();
+    in.seekg(0, std::ios::beg);
+    _input.assign(std::istreambuf_iterator<char>(in),
+                  std::istreambuf_iterator<char>());
+  }
+
+  if (in.bad()) {
+    return false;
+  }
+
+  _guard_state = GS_start;
+  set_buffer();
+  return true;
 }
 
 /**
@@ -259,11 +292,25 @@ open(const CPPFile &file) {
  */
 bool CPPPreprocessor::InputFile::
 connect_input(const string &input) {
-  assert(_in == nullptr);
+  assert(_ptr == nullptr);
 
   _input = input;
-  _in = new std::istringstream(_input);
-  return !_in->fail();
+  set_buffer();
+  return true;
+}
+
+/**
+ * Prepares _input for reading.  Quietly removes any embedded carriage-return
+ * characters.  We shouldn't see any of these unless there was some
+ * DOS-to-Unix file conversion problem.
+ */
+void CPPPreprocessor::InputFile::
+set_buffer() {
+  if (_input.find('\r') != string::npos) {
+    _input.erase(std::remove(_input.begin(), _input.end(), '\r'), _input.end());
+  }
+  _ptr = _input.data();
+  _end = _ptr + _input.size();
 }
 
 /**
@@ -271,34 +318,24 @@ connect_input(const string &input) {
  */
 int CPPPreprocessor::InputFile::
 get() {
-  assert(_in != nullptr);
+  assert(_ptr != nullptr);
 
   if (!_lock_position) {
     _line_number = _next_line_number;
     _col_number = _next_col_number;
   }
 
-  int c = _in->get();
-
-  // Quietly skip over embedded carriage-return characters.  We shouldn't see
-  // any of these unless there was some DOS-to-Unix file conversion problem.
-  while (c == '\r') {
-    c = _in->get();
+  if (UNLIKELY(_ptr >= _end)) {
+    return EOF;
   }
 
-  switch (c) {
-  case EOF:
-    break;
+  int c = (unsigned char)*_ptr++;
 
-  case '\n':
-    if (!_lock_position) {
+  if (!_lock_position) {
+    if (c == '\n') {
       ++_next_line_number;
       _next_col_number = 1;
-    }
-    break;
-
-  default:
-    if (!_lock_position) {
+    } else {
       ++_next_col_number;
     }
   }
@@ -311,18 +348,34 @@ get() {
  */
 int CPPPreprocessor::InputFile::
 peek() {
-  assert(_in != nullptr);
-
-  int c = _in->peek();
+  assert(_ptr != nullptr);
 
-  // Quietly skip over embedded carriage-return characters.  We shouldn't see
-  // any of these unless there was some DOS-to-Unix file conversion problem.
-  while (c == '\r') {
-    _in->get();
-    c = _in->peek();
+  if (UNLIKELY(_ptr >= _end)) {
+    return EOF;
   }
+  return (unsigned char)*_ptr;
+}
 
-  return c;
+/**
+ * Returns the text being read, for the benefit of error messages.
+ */
+string CPPPreprocessor::InputFile::
+get_input() const {
+  if (_argument) {
+    return _parent->get_input();
+  }
+  if (_tokens != nullptr && _manifest != nullptr) {
+    CPPManifest::Ignores ignores;
+    for (const InputFile *infile = this; infile != nullptr;
+         infile = infile->_parent) {
+      if (infile->_ignore_manifest) {
+        ignores.insert(infile->_manifest);
+      }
+    }
+    ignores.insert(_manifest);
+    return _manifest->expand(_args, false, ignores);
+  }
+  return _input;
 }
 
 /**
@@ -759,7 +812,7 @@ error(const string &message, const YYLTYPE &loc) const {
         if (_verbose >= 3) {
           cerr << "Expansion of " << (*rit)->_manifest->_name << ":\n";
           while (rit != infiles.rend()) {
-            cerr << " -> " << trim_blanks((*rit)->_input) << "\n";
+            cerr << " -> " << trim_blanks((*rit)->get_input()) << "\n";
             ++rit;
           }
         }
@@ -768,7 +821,7 @@ error(const string &message, const YYLTYPE &loc) const {
           if ((*rit)->_manifest->_has_parameters) {
             cerr << "()";
           }
-          cerr << " expanded to: " << trim_blanks(_infile->_input) << "\n";
+          cerr << " expanded to: " << trim_blanks(_infile->get_input()) << "\n";
         }
         cerr << std::endl;
       }
@@ -859,29 +912,31 @@ get_error_count() const {
  */
 CPPCommentBlock *CPPPreprocessor::
 get_comment_before(int line, CPPFile file) {
-  CPPComments::reverse_iterator ci;
-  ci = _comments.rbegin();
-
-  int wrong_file_count = 0;
-  while (ci != _comments.rend()) {
-    CPPCommentBlock *comment = (*ci);
-    if (comment->_file == file) {
-      wrong_file_count = 0;
-      if (comment->_last_line == line || comment->_last_line == line - 1) {
-        return comment;
-      }
-
-      if (comment->_last_line < line) {
-        return nullptr;
-      }
+  FileComments::const_iterator fi = _file_comments.find(file);
+  if (fi == _file_comments.end()) {
+    return nullptr;
+  }
+  const CommentIndex &comments = (*fi).second;
+
+  // Find the last comment that ends on or before the indicated line.  The
+  // comments of a file are stored in the order they appear, so they are
+  // sorted by line.
+  size_t lo = 0;
+  size_t hi = comments.size();
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (comments[mid]->_last_line <= line) {
+      lo = mid + 1;
     } else {
-      wrong_file_count++;
-      if (wrong_file_count > 10) {
-        return nullptr;
-      }
+      hi = mid;
     }
+  }
 
-    ++ci;
+  if (lo > 0) {
+    CPPCommentBlock *comment = comments[lo - 1];
+    if (comment->_last_line == line || comment->_last_line == line - 1) {
+      return comment;
+    }
   }
 
   return nullptr;
@@ -893,25 +948,51 @@ get_comment_before(int line, CPPFile file) {
  */
 CPPCommentBlock *CPPPreprocessor::
 get_comment_on(int line, CPPFile file) {
-  CPPComments::reverse_iterator ci;
-  ci = _comments.rbegin();
+  FileComments::const_iterator fi = _file_comments.find(file);
+  if (fi == _file_comments.end()) {
+    return nullptr;
+  }
+  const CommentIndex &comments = (*fi).second;
 
-  while (ci != _comments.rend()) {
-    CPPCommentBlock *comment = (*ci);
-    if (comment->_file == file) {
-      if (comment->_line_number == line) {
-        return comment;
-      } else if (comment->_line_number < line) {
-        return nullptr;
-      }
+  // Find the last comment that starts on or before the indicated line.
+  size_t lo = 0;
+  size_t hi = comments.size();
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (comments[mid]->_line_number <= line) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
     }
+  }
 
-    ++ci;
+  if (lo > 0 && comments[lo - 1]->_line_number == line) {
+    return comments[lo - 1];
   }
 
   return nullptr;
 }
 
+/**
+ * Adds a newly encountered comment to _comments, and to the index used by
+ * get_comment_before() and get_comment_on().  The comment's file and starting
+ * line must already be filled in.
+ */
+void CPPPreprocessor::
+add_comment(CPPCommentBlock *comment) {
+  _comments.push_back(comment);
+
+  CommentIndex &comments = _file_comments[comment->_file];
+  if (!comments.empty() &&
+      comments.back()->_last_line > comment->_line_number) {
+    // The file is being read again.  Anything we look up from now on will be
+    // found in this reading of the file, so forget about the previous one to
+    // keep the index sorted.
+    comments.clear();
+  }
+  comments.push_back(comment);
+}
+
 /**
  *
  */
@@ -924,6 +1005,18 @@ init_cpp(const CPPFile &file) {
   return push_file(file);
 }
 
+/**
+ * Like init_cpp(), but reads the tokens of a file from a snapshot stream.
+ */
+bool CPPPreprocessor::
+init_snapshot_stream(const CPPSnapshot::Stream &stream) {
+  _state = S_normal;
+  _saved_tokens.push_back(CPPToken(START_CPP));
+  _last_c = '\0';
+
+  return push_snapshot_stream(stream);
+}
+
 /**
  *
  */
@@ -1045,6 +1138,55 @@ push_expansion(const string &input, const CPPManifest *manifest, const YYLTYPE &
   return false;
 }
 
+/**
+ * Like push_expansion(), but replays the cached tokens of the indicated
+ * manifest instead of lexing its expansion string.
+ */
+bool CPPPreprocessor::
+push_expansion_tokens(const CPPManifest *manifest, const YYLTYPE &loc) {
+  assert(manifest->_token_state == CPPManifest::TS_cached);
+  assert(!manifest->_has_parameters);
+
+#ifdef CPP_VERBOSE_LEX
+  indent(cerr, get_file_depth() * 2)
+    << "Pushing to cached expansion of " << manifest->_name << "\n";
+#endif
+
+  InputFile *infile = new InputFile;
+  infile->connect_input(string());
+  infile->_tokens = &manifest->_tokens;
+  infile->_manifest = manifest;
+  infile->_file = loc.file;
+  infile->_line_number = loc.first_line;
+  infile->_col_number = loc.first_column;
+  infile->_lock_position = true;
+  infile->_ignore_manifest = true;
+
+  infile->_prev_last_c = _last_c;
+  infile->_parent = _infile;
+  _infile = infile;
+  _last_c = '\0';
+  return true;
+}
+
+/**
+ * Pushes a token stream read from a snapshot, to be replayed as though the
+ * file it came from were being read.
+ */
+bool CPPPreprocessor::
+push_snapshot_stream(const CPPSnapshot::Stream &stream) {
+  InputFile *infile = new InputFile;
+  infile->connect_input(string());
+  infile->_tokens = &stream._tokens;
+  infile->_comments = &stream._comments;
+
+  infile->_prev_last_c = _last_c;
+  infile->_parent = _infile;
+  _infile = infile;
+  _last_c = '\0';
+  return true;
+}
+
 /**
  * Given a string, expand all manifests within the string.
  */
@@ -1168,14 +1310,72 @@ parse_expr(const string &input_expr, CPPScope *current_scope,
 }
 
 /**
- *
+ * Returns the next token from the input, recording it in _record_stream if we
+ * are saving a snapshot.
  */
 CPPToken CPPPreprocessor::
 internal_get_next_token() {
+  if (_record_stream == nullptr ||
+      _state == S_eof || _state == S_end_nested) {
+    return read_next_token();
+  }
+
+  bool parsing_template_params = _parsing_template_params;
+  size_t num_saved_tokens = _saved_tokens.size();
+  size_t num_comments = _comments.size();
+
+  CPPToken token = read_next_token();
+
+  // Any comments we passed over are restored just before this token.
+  std::vector<CPPToken> &tokens = _record_stream->_tokens;
+  CPPComments::const_iterator ci = _comments.end();
+  std::advance(ci, -(std::ptrdiff_t)(_comments.size() - num_comments));
+  for (; ci != _comments.end(); ++ci) {
+    _record_stream->_comments.push_back(std::make_pair(tokens.size(), *ci));
+  }
+
+  if (token._token == 0) {
+    if (_state == S_end_nested) {
+      // This was the comma or closing angle bracket that ended the nested
+      // lexer.  Record it as such, so that check_nesting() will see it again.
+      tokens.push_back(token);
+      tokens.back()._token =
+        (parsing_template_params && !_parsing_template_params) ? '>' : ',';
+    }
+    return token;
+  }
+
+  size_t first_token = tokens.size();
+  tokens.push_back(token);
+
+  // get_literal() may have pushed the token that follows onto the saved
+  // token stack.
+  for (size_t i = _saved_tokens.size(); i > num_saved_tokens; --i) {
+    tokens.push_back(_saved_tokens[i - 1]);
+  }
+
+  // The parser may modify string literals, so we must store a copy.
+  for (size_t i = first_token; i < tokens.size(); ++i) {
+    if (tokens[i]._token == STRING_LITERAL) {
+      tokens[i]._lval.u.expr = new CPPExpression(*tokens[i]._lval.u.expr);
+    }
+  }
+  return token;
+}
+
+/**
+ *
+ */
+CPPToken CPPPreprocessor::
+read_next_token() {
   if (_state == S_eof || _state == S_end_nested) {
     return CPPToken::eof();
   }
 
+  if (_infile != nullptr && _infile->_tokens != nullptr) {
+    return get_expansion_token();
+  }
+
   int c = _last_c;
   _last_c = '\0';
   if (c == '\0' || c == EOF) {
@@ -1189,6 +1389,12 @@ internal_get_next_token() {
     c = skip_whitespace(process_directive(c));
   }
 
+  if (c != EOF && _infile != nullptr &&
+      _infile->_guard_state != InputFile::GS_in_guard) {
+    // There is a token outside the include guard.
+    _infile->_guard_state = InputFile::GS_none;
+  }
+
   if (c == '\'') {
     return get_quoted_char(c);
   } else if (c == '"') {
@@ -1233,6 +1439,163 @@ internal_get_next_token() {
     return CPPToken(di, loc);
   }
 
+  if (check_nesting(c)) {
+    return CPPToken(0, loc);
+  }
+
+  // Look for an end-of-line comment, and parse it before we finish this
+  // token.  This is not strictly necessary, but it allows us to pick up
+  // docstrings from comments after enum values.
+  while (next_c != EOF && isspace(next_c)) {
+    get();
+    next_c = peek();
+  }
+  if (next_c == '/') {
+    _last_c = skip_whitespace(get());
+  }
+
+  return CPPToken(c, loc);
+}
+
+/**
+ * Returns the next token from the cached expansion of a manifest or from a
+ * snapshot stream, which must be the current input.
+ */
+CPPToken CPPPreprocessor::
+get_expansion_token() {
+  InputFile *infile = _infile;
+  const std::vector<CPPToken> &tokens = *infile->_tokens;
+
+  if (infile->_comments != nullptr && _save_comments) {
+    // Restore the comments that were read before this token.
+    const CPPSnapshot::Comments &comments = *infile->_comments;
+    while (infile->_next_comment < comments.size() &&
+           comments[infile->_next_comment].first <= infile->_next_token) {
+      add_comment(comments[infile->_next_comment++].second);
+    }
+  }
+
+  if (infile->_next_token >= tokens.size()) {
+    // We've reached the end of the expansion.  Pop it off, and carry on
+    // reading from the previous input, just as get() would have done.
+    _infile = infile->_parent;
+    delete infile;
+    _start_of_line = true;
+    if (_infile != nullptr && _infile->_tokens != nullptr) {
+      return get_expansion_token();
+    }
+    _last_c = '\n';
+    return read_next_token();
+  }
+
+  if (infile->_token_params != nullptr &&
+      (*infile->_token_params)[infile->_next_token] >= 0) {
+    // Replay the tokens of the argument substituted for this parameter.
+    int i = (*infile->_token_params)[infile->_next_token++];
+    InputFile *argfile = new InputFile;
+    argfile->connect_input(string());
+    argfile->_tokens = &infile->_arg_tokens[i];
+    argfile->_argument = true;
+    argfile->_manifest = infile->_manifest;
+    argfile->_file = infile->_file;
+    argfile->_line_number = infile->_line_number;
+    argfile->_col_number = infile->_col_number;
+    argfile->_lock_position = true;
+    argfile->_parent = infile;
+    _infile = argfile;
+    return get_expansion_token();
+  }
+
+  CPPToken token = tokens[infile->_next_token++];
+  YYLTYPE &loc = token._lloc;
+  bool single_char = (token._token < 256 && loc.last_column == loc.first_column);
+
+  if (infile->_manifest != nullptr) {
+    // The cached tokens were lexed with a position of 1:1; all tokens from an
+    // expansion are reported at the position of the manifest.
+    loc.file = infile->_file;
+    loc.first_line = infile->_line_number;
+    loc.last_line = infile->_line_number;
+    loc.last_column += infile->_col_number - 1;
+    loc.first_column = infile->_col_number;
+  }
+
+  switch (token._token) {
+  case SIMPLE_IDENTIFIER:
+    if (infile->_manifest != nullptr) {
+      // can_replay_tokens() has already verified that any manifest we
+      // encounter here can be replayed as well.  Snapshot streams have
+      // already had their manifests expanded.
+      Manifests::const_iterator mi = _manifests.find(token._lval.str);
+      if (mi != _manifests.end() && !should_ignore_manifest((*mi).second)) {
+        push_expansion_tokens((*mi).second, loc);
+        return read_next_token();
+      }
+    }
+    break;
+
+  case STRING_LITERAL:
+    // The parser may modify this expression when concatenating strings.
+    token._lval.u.expr = new CPPExpression(*token._lval.u.expr);
+    break;
+
+  case ATTR_LEFT:
+    _parsing_attribute = true;
+    break;
+
+  case ATTR_RIGHT:
+    _parsing_attribute = false;
+    break;
+
+  case KW_BEGIN_PUBLISH:
+    preprocessor_vis = V_published;
+    break;
+
+  case KW_END_PUBLISH:
+    preprocessor_vis = V_public;
+    break;
+  }
+
+  if (single_char) {
+    if (check_nesting(token._token)) {
+      return CPPToken(0, loc);
+    }
+
+    if (infile->_manifest != nullptr && infile->_next_token >= tokens.size()) {
+      // This was the last token of the expansion.  Look for an end-of-line
+      // comment in the input that follows, as read_next_token() would have
+      // done.
+      do {
+        _infile = infile->_parent;
+        delete infile;
+        infile = _infile;
+      } while (infile != nullptr && infile->_tokens != nullptr &&
+               infile->_next_token >= infile->_tokens->size());
+      _start_of_line = true;
+
+      if (infile == nullptr || infile->_tokens == nullptr) {
+        int next_c = peek();
+        while (next_c != EOF && isspace(next_c)) {
+          get();
+          next_c = peek();
+        }
+        if (next_c == '/') {
+          _last_c = skip_whitespace(get());
+        }
+      }
+    }
+  }
+
+  return token;
+}
+
+/**
+ * Keeps track of the paren nesting when running a nested lexer or parsing an
+ * attribute.  Returns true if the indicated single-character token ends the
+ * nested lexer, in which case an empty token should be returned instead.
+ */
+bool CPPPreprocessor::
+check_nesting(int c) {
   if (_state == S_nested) {
     // If we're running a nested lexer, keep track of the paren levels.  When
     // we encounter a comma or closing angle bracket at the bottom level, we
@@ -1252,7 +1615,7 @@ internal_get_next_token() {
     case ',':
       if (_paren_nesting <= 0) {
         _state = S_end_nested;
-        return CPPToken(0, loc);
+        return true;
       }
       break;
 
@@ -1260,7 +1623,7 @@ internal_get_next_token() {
       if (_paren_nesting <= 0) {
         _parsing_template_params = false;
         _state = S_end_nested;
-        return CPPToken(0, loc);
+        return true;
       }
     }
   } else if (_parsing_attribute) {
@@ -1272,18 +1635,7 @@ internal_get_next_token() {
     }
   }
 
-  // Look for an end-of-line comment, and parse it before we finish this
-  // token.  This is not strictly necessary, but it allows us to pick up
-  // docstrings from comments after enum values.
-  while (next_c != EOF && isspace(next_c)) {
-    get();
-    next_c = peek();
-  }
-  if (next_c == '/') {
-    _last_c = skip_whitespace(get());
-  }
-
-  return CPPToken(c, loc);
+  return false;
 }
 
 /**
@@ -1487,14 +1839,13 @@ skip_c_comment(int c) {
 
   if (_save_comments) {
     CPPCommentBlock *comment = new CPPCommentBlock;
-    _comments.push_back(comment);
-
     comment->_file = loc.file;
     comment->_line_number = loc.first_line;
     comment->_last_line = loc.last_line;
     comment->_col_number = loc.first_column;
     comment->_c_style = true;
     comment->_comment = "/*";
+    add_comment(comment);
 
     while (c != EOF) {
       if (c == '*') {
@@ -1574,7 +1925,7 @@ skip_cpp_comment(int c) {
       comment->_c_style = false;
       comment->_comment = "//";
 
-      _comments.push_back(comment);
+      add_comment(comment);
     }
 
     while (c != EOF && c != '\n') {
@@ -1666,6 +2017,11 @@ process_directive(int c) {
     << "#" << command << " " << args << "\n";
 #endif
 
+  InputFile *infile = _infile;
+  if (infile->_guard_state != InputFile::GS_in_guard) {
+    check_include_guard(command, args);
+  }
+
   if (command == "define") {
     handle_define_directive(args, loc);
   } else if (command == "undef") {
@@ -1680,9 +2036,19 @@ process_directive(int c) {
     // Presumably this follows some #if or #ifdef.  We don't bother to check
     // this, however.
     skip_false_if_block(false);
+    if (infile == _infile && --infile->_if_depth <= 0 &&
+        infile->_guard_state == InputFile::GS_in_guard) {
+      // The guard block has an #else clause, so it doesn't cover the file.
+      infile->_guard_state = InputFile::GS_none;
+    }
   } else if (command == "endif") {
     // Presumably this follows some #if or #ifdef.  We don't bother to check
     // this, however.
+    if (--infile->_if_depth <= 0 &&
+        infile->_guard_state == InputFile::GS_in_guard) {
+      infile->_guard_state = (infile->_if_depth == 0)
+        ? InputFile::GS_after_guard : InputFile::GS_none;
+    }
   } else if (command == "include") {
     handle_include_directive(args, loc);
   } else if (command == "pragma") {
@@ -1814,6 +2180,8 @@ handle_ifdef_directive(const string &args, const YYLTYPE &loc) {
   if (!is_manifest_defined(args)) {
     // The macro is undefined.  Skip stuff.
     skip_false_if_block(true);
+  } else {
+    begin_if_block();
   }
 }
 
@@ -1825,6 +2193,8 @@ handle_ifndef_directive(const string &args, const YYLTYPE &loc) {
   if (is_manifest_defined(args)) {
     // The macro is defined.  Skip stuff.
     skip_false_if_block(true);
+  } else {
+    begin_if_block();
   }
 }
 
@@ -1855,6 +2225,7 @@ handle_if_directive(const string &args, const YYLTYPE &loc) {
 
   if (expression_result) {
     // The expression result is true.  We continue.
+    begin_if_block();
     return;
   }
 
@@ -1929,9 +2300,9 @@ handle_include_directive(const string &args, const YYLTYPE &loc) {
 
     CPPFile file(filename, filename_as_referenced, source);
 
-    // Don't include it if we included it before and it had #pragma once.
-    ParsedFiles::const_iterator it = _parsed_files.find(file);
-    if (it != _parsed_files.end() && it->_pragma_once) {
+    // Don't include it if we included it before and it had #pragma once, or
+    // if it is wrapped in an include guard that is still defined.
+    if (is_include_guarded(file)) {
       return;
     }
 
@@ -2036,6 +2407,7 @@ skip_false_if_block(bool consider_elifs) {
         if (level == 0 && consider_elifs) {
           // This will do!
           _save_comments = true;
+          begin_if_block();
           return;
         }
       } else if (command == "elif") {
@@ -2074,6 +2446,82 @@ skip_false_if_block(bool consider_elifs) {
   _save_comments = true;
 }
 
+/**
+ * Called when we enter the body of an #if, #ifdef, #ifndef, #elif or #else
+ * block whose condition was satisfied, to keep track of the nesting level
+ * within the current file.
+ */
+void CPPPreprocessor::
+begin_if_block() {
+  if (_infile != nullptr) {
+    ++_infile->_if_depth;
+  }
+}
+
+/**
+ * Called for each directive encountered outside the body of a potential
+ * include guard.  If this is the first thing in the file, and it is an
+ * #ifndef (or equivalent #if !defined) directive, remembers the macro as a
+ * candidate include guard.  Otherwise, the file can't be guarded.
+ */
+void CPPPreprocessor::
+check_include_guard(const string &command, const string &args) {
+  InputFile *infile = _infile;
+  if (infile->_guard_state != InputFile::GS_start) {
+    infile->_guard_state = InputFile::GS_none;
+    return;
+  }
+  infile->_guard_state = InputFile::GS_none;
+
+  string macro;
+  if (command == "ifndef") {
+    macro = args;
+  }
+  else if (command == "if" && !args.empty() && args[0] == '!') {
+    // Also accept #if !defined(MACRO) and #if !defined MACRO.
+    size_t p = 1;
+    while (p < args.size() && isspace(args[p])) {
+      ++p;
+    }
+    if (args.compare(p, 7, "defined") != 0) {
+      return;
+    }
+    p += 7;
+    while (p < args.size() && isspace(args[p])) {
+      ++p;
+    }
+    bool paren = (p < args.size() && args[p] == '(');
+    if (paren) {
+      ++p;
+    }
+    size_t q = p;
+    while (p < args.size() && (isalnum(args[p]) || args[p] == '_')) {
+      ++p;
+    }
+    macro = args.substr(q, p - q);
+    while (p < args.size() && isspace(args[p])) {
+      ++p;
+    }
+    if (paren) {
+      if (p >= args.size() || args[p] != ')') {
+        return;
+      }
+      ++p;
+    }
+    if (p != args.size()) {
+      return;
+    }
+  }
+  else {
+    return;
+  }
+
+  if (!macro.empty() && !is_manifest_defined(macro)) {
+    infile->_guard_state = InputFile::GS_in_guard;
+    infile->_guard_macro = macro;
+  }
+}
+
 /**
  * Returns true if the given manifest is defined.
  */
@@ -2094,6 +2542,24 @@ is_manifest_defined(const string &manifest_name) const {
   return false;
 }
 
+/**
+ * Returns true if the given file has been read before and need not be read
+ * again, either because it contained #pragma once, or because it is entirely
+ * wrapped in an include guard whose macro is currently defined.
+ */
+bool CPPPreprocessor::
+is_include_guarded(const CPPFile &file) const {
+  ParsedFiles::const_iterator it = _parsed_files.find(file);
+  if (it == _parsed_files.end()) {
+    return false;
+  }
+  if (it->_pragma_once) {
+    return true;
+  }
+  return !it->_include_guard.empty() &&
+         _manifests.find(it->_include_guard) != _manifests.end();
+}
+
 /**
  * Locates the given filename.  Changes the first argument to the full path.
  */
@@ -2505,6 +2971,15 @@ expand_manifest(const CPPManifest *manifest, const YYLTYPE &loc) {
                           manifest->_variadic_param, args);
   }
 
+  if (!manifest->_has_parameters) {
+    // We may be able to avoid lexing the expansion again.
+    CPPManifest::Ignores checked;
+    if (can_replay_tokens(manifest, checked)) {
+      push_expansion_tokens(manifest, loc);
+      return read_next_token();
+    }
+  }
+
   // Keep track of the manifests we're supposed to ignore.
   CPPManifest::Ignores ignores;
   ignores.insert(manifest);
@@ -2517,6 +2992,11 @@ expand_manifest(const CPPManifest *manifest, const YYLTYPE &loc) {
     infile = infile->_parent;
   }
 
+  if (manifest->_has_parameters &&
+      push_expansion_args(manifest, args, ignores, loc)) {
+    return read_next_token();
+  }
+
   string expanded = " " + manifest->expand(args, false, ignores) + " ";
   push_expansion(expanded, manifest, loc);
 
@@ -2525,7 +3005,278 @@ expand_manifest(const CPPManifest *manifest, const YYLTYPE &loc) {
     << "Expanding " << manifest->_name << " to " << expanded << "\n";
 #endif
 
-  return internal_get_next_token();
+  return read_next_token();
+}
+
+/**
+ * Lexes the expansion of the indicated manifest into a list of tokens that can
+ * be replayed each time it is expanded.  Manifests are not expanded at this
+ * stage, since their definitions may change before the next expansion.  If
+ * the manifest takes parameters, each reference to a parameter is lexed as a
+ * placeholder identifier, which is recorded in _token_params.  If the
+ * expansion contains anything that would not lex the same way every time, the
+ * manifest is marked uncacheable instead.
+ */
+void CPPPreprocessor::
+lex_manifest_tokens(const CPPManifest *manifest) {
+  manifest->_token_state = CPPManifest::TS_uncacheable;
+  manifest->_tokens.clear();
+  manifest->_token_params.clear();
+
+  static const string param_prefix = "__cpp_manifest_param_";
+
+  string expanded = " " + manifest->expand() + " ";
+  if (expanded.find("__FILE__") != string::npos ||
+      expanded.find("__LINE__") != string::npos ||
+      expanded.find(param_prefix) != string::npos) {
+    return;
+  }
+
+  if (manifest->_has_parameters) {
+    // The arguments are substituted as tokens, which can't be stringified or
+    // pasted.
+    if (!manifest->can_substitute_tokens()) {
+      return;
+    }
+    vector_string params;
+    for (size_t i = 0; i < manifest->_num_parameters; ++i) {
+      params.push_back(param_prefix + format_string(i));
+    }
+    expanded = " " + manifest->expand(params) + " ";
+  }
+
+  std::vector<CPPToken> tokens;
+  if (!lex_expansion(expanded, tokens)) {
+    return;
+  }
+
+  if (!tokens.empty() && (tokens.back()._token == KW_EXPLICIT ||
+                          tokens.back()._token == KW_NOEXCEPT)) {
+    // These look ahead for a following parenthesis, which may come after the
+    // expansion.
+    return;
+  }
+
+  if (manifest->_has_parameters) {
+    for (const CPPToken &token : tokens) {
+      int param = -1;
+      if (token._token == SIMPLE_IDENTIFIER &&
+          token._lval.str.compare(0, param_prefix.size(), param_prefix) == 0) {
+        param = atoi(token._lval.str.c_str() + param_prefix.size());
+      }
+      manifest->_token_params.push_back(param);
+    }
+  }
+
+  manifest->_tokens = std::move(tokens);
+  manifest->_token_state = CPPManifest::TS_cached;
+}
+
+/**
+ * Lexes the indicated string into a list of tokens, without expanding any
+ * manifests.  Returns false if the string contains anything that would not
+ * lex the same way every time, or in every context.
+ */
+bool CPPPreprocessor::
+lex_expansion(const string &expanded, std::vector<CPPToken> &tokens) {
+  // We use a separate lexer, which does not know about any manifests, and
+  // which won't report any errors.
+  CPPPreprocessor lexer;
+  lexer._verbose = 0;
+  lexer._state = S_normal;
+  lexer._save_comments = false;
+  lexer.push_string(expanded);
+  lexer._infile->_line_number = 1;
+  lexer._infile->_col_number = 1;
+  lexer._infile->_lock_position = true;
+  lexer._infile->_ignore_manifest = true;
+
+  CPPVisibility vis = preprocessor_vis;
+  CPPToken token = lexer.internal_get_next_token();
+  while (!token.is_eof()) {
+    switch (token._token) {
+    case 0:
+    case CUSTOM_LITERAL:
+      // Custom literals depend on which literal operators are in scope.
+      preprocessor_vis = vis;
+      return false;
+
+    case RSHIFT:
+    case RSHIFTEQUAL:
+    case GECOMPARE:
+      // These are lexed differently when parsing template parameters.
+      preprocessor_vis = vis;
+      return false;
+    }
+    tokens.push_back(std::move(token));
+    token = lexer.internal_get_next_token();
+  }
+  preprocessor_vis = vis;
+
+  return lexer.get_error_count() == 0 && lexer.get_warning_count() == 0;
+}
+
+/**
+ * Returns true if the indicated string contains a quoted string or character
+ * that is not closed.
+ */
+static bool
+has_unclosed_quote(const string &str) {
+  size_t p = 0;
+  while (p < str.size()) {
+    if (str[p] == '"' || str[p] == '\'') {
+      char quote = str[p++];
+      while (p < str.size() && str[p] != quote) {
+        if (str[p] == '\\') {
+          ++p;
+        }
+        ++p;
+      }
+      if (p >= str.size()) {
+        return true;
+      }
+    }
+    ++p;
+  }
+  return false;
+}
+
+/**
+ * Expands the indicated manifest, which takes parameters, by replaying its
+ * cached tokens and substituting the tokens of the given arguments for its
+ * parameters, and pushes the result as the new input.  This avoids lexing the
+ * expansion of the manifest again, though the arguments still need to be
+ * lexed.  Returns false, without pushing anything, if the expansion can't be
+ * done this way, in which case the expansion string has to be lexed instead.
+ */
+bool CPPPreprocessor::
+push_expansion_args(const CPPManifest *manifest, const vector_string &args,
+                    const CPPManifest::Ignores &ignores, const YYLTYPE &loc) {
+  assert(manifest->_has_parameters);
+  if (manifest->_token_state == CPPManifest::TS_unknown) {
+    lex_manifest_tokens(manifest);
+  }
+  if (manifest->_token_state != CPPManifest::TS_cached) {
+    return false;
+  }
+
+  // Expand and lex each argument that is referenced, just as
+  // CPPManifest::expand() would have expanded it.
+  std::vector<std::vector<CPPToken> > arg_tokens(manifest->_num_parameters);
+  std::vector<bool> lexed(manifest->_num_parameters, false);
+  for (int i : manifest->_token_params) {
+    if (i < 0 || lexed[i]) {
+      continue;
+    }
+    lexed[i] = true;
+    if (i >= (int)args.size()) {
+      continue;
+    }
+    string subst = args[i];
+    if (i == manifest->_variadic_param) {
+      for (size_t j = i + 1; j < args.size(); ++j) {
+        subst += ", " + args[j];
+      }
+    }
+    if (subst.find("/*") != string::npos ||
+        subst.find("//") != string::npos ||
+        has_unclosed_quote(subst)) {
+      // Comments in the arguments are read along with the expansion, and an
+      // unclosed quote runs on into it.
+      return false;
+    }
+    expand_manifests(subst, false, ignores);
+    if (!lex_expansion(" " + subst + " ", arg_tokens[i])) {
+      return false;
+    }
+  }
+
+  // Any manifest we encounter while replaying the result must be replayable
+  // as well.  As with push_expansion(), the manifest itself is not ignored,
+  // and since it takes parameters, it can't be replayed.
+  CPPManifest::Ignores checked;
+  const CPPToken *last_token = nullptr;
+  for (size_t t = 0; t < manifest->_tokens.size(); ++t) {
+    int i = manifest->_token_params[t];
+    const std::vector<CPPToken> &tokens = (i < 0)
+      ? manifest->_tokens : arg_tokens[i];
+    size_t begin = (i < 0) ? t : 0;
+    size_t end = (i < 0) ? t + 1 : tokens.size();
+    for (size_t ti = begin; ti < end; ++ti) {
+      const CPPToken &token = tokens[ti];
+      last_token = &token;
+      if (token._token == SIMPLE_IDENTIFIER) {
+        Manifests::const_iterator mi = _manifests.find(token._lval.str);
+        if (mi != _manifests.end() && checked.count((*mi).second) == 0 &&
+            !should_ignore_manifest((*mi).second) &&
+            !can_replay_tokens((*mi).second, checked)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  if (last_token != nullptr && (last_token->_token == KW_EXPLICIT ||
+                                last_token->_token == KW_NOEXCEPT)) {
+    return false;
+  }
+
+#ifdef CPP_VERBOSE_LEX
+  indent(cerr, get_file_depth() * 2)
+    << "Pushing to cached expansion of " << manifest->_name << "()\n";
+#endif
+
+  InputFile *infile = new InputFile;
+  infile->connect_input(string());
+  infile->_tokens = &manifest->_tokens;
+  infile->_token_params = &manifest->_token_params;
+  infile->_args = args;
+  infile->_arg_tokens = std::move(arg_tokens);
+  infile->_manifest = manifest;
+  infile->_file = loc.file;
+  infile->_line_number = loc.first_line;
+  infile->_col_number = loc.first_column;
+  infile->_lock_position = true;
+
+  infile->_prev_last_c = _last_c;
+  infile->_parent = _infile;
+  _infile = infile;
+  _last_c = '\0';
+  return true;
+}
+
+/**
+ * Returns true if the cached tokens of the indicated manifest can be replayed
+ * in the current context, lexing them first if necessary.  This is only the
+ * case if all the manifests it refers to can be replayed as well; the
+ * arguments to a manifest taking parameters, in particular, must be read as
+ * characters.  The checked set accumulates the manifests that have already
+ * been considered.
+ */
+bool CPPPreprocessor::
+can_replay_tokens(const CPPManifest *manifest, CPPManifest::Ignores &checked) {
+  if (manifest->_has_parameters) {
+    return false;
+  }
+  if (manifest->_token_state == CPPManifest::TS_unknown) {
+    lex_manifest_tokens(manifest);
+  }
+  if (manifest->_token_state != CPPManifest::TS_cached) {
+    return false;
+  }
+
+  checked.insert(manifest);
+  for (const CPPToken &token : manifest->_tokens) {
+    if (token._token == SIMPLE_IDENTIFIER) {
+      Manifests::const_iterator mi = _manifests.find(token._lval.str);
+      if (mi != _manifests.end() && checked.count((*mi).second) == 0 &&
+          !should_ignore_manifest((*mi).second) &&
+          !can_replay_tokens((*mi).second, checked)) {
+        return false;
+      }
+    }
+  }
+  return true;
 }
 
 /**
@@ -3109,6 +3860,15 @@ get() {
     // Pop the last file off the end.
     InputFile *infile = _infile;
     _infile = infile->_parent;
+
+    if (infile->_guard_state == InputFile::GS_after_guard) {
+      // The whole file was wrapped in an include guard.  Record this so that
+      // we can skip it entirely next time it is included.
+      ParsedFiles::iterator it = _parsed_files.find(infile->_file);
+      if (it != _parsed_files.end()) {
+        it->_include_guard = infile->_guard_macro;
+      }
+    }
     delete infile;
 
     // Synthesize a newline, just in case the file doesn't already end with
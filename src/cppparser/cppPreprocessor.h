@@ -20,6 +20,7 @@
 #include "cppToken.h"
 #include "cppFile.h"
 #include "cppCommentBlock.h"
+#include "cppSnapshot.h"
 
 #include "dSearchPath.h"
 #include "vector_string.h"
@@ -111,12 +112,19 @@ public:
 
 protected:
   bool init_cpp(const CPPFile &file);
+  bool init_snapshot_stream(const CPPSnapshot::Stream &stream);
   bool init_const_expr(const std::string &expr);
   bool init_type(const std::string &type);
   bool push_file(const CPPFile &file);
   bool push_string(const std::string &input);
   bool push_expansion(const std::string &input, const CPPManifest *manifest,
                       const YYLTYPE &loc);
+  bool push_expansion_tokens(const CPPManifest *manifest, const YYLTYPE &loc);
+  bool push_snapshot_stream(const CPPSnapshot::Stream &stream);
+
+  // If this is set, all tokens read are appended to this stream, so that
+  // they can be saved to a snapshot.
+  CPPSnapshot::Stream *_record_stream = nullptr;
 
 public:
   void expand_manifests(std::string &expr, bool expand_undefined = false,
@@ -126,6 +134,9 @@ public:
 
 private:
   CPPToken internal_get_next_token();
+  CPPToken read_next_token();
+  CPPToken get_expansion_token();
+  bool check_nesting(int c);
   int check_digraph(int c);
   int check_trigraph(int c);
   int skip_whitespace(int c);
@@ -149,7 +160,10 @@ private:
   void handle_warning_directive(const std::string &args, const YYLTYPE &loc);
 
   void skip_false_if_block(bool consider_elifs);
+  void begin_if_block();
+  void check_include_guard(const std::string &command, const std::string &args);
   bool is_manifest_defined(const std::string &manifest_name) const;
+  bool is_include_guarded(const CPPFile &file) const;
   bool find_include(Filename &filename, bool angle_quotes, CPPFile::Source &source) const;
 
   CPPToken get_quoted_char(int c);
@@ -158,6 +172,15 @@ private:
   CPPToken get_literal(int token, YYLTYPE loc, const std::string &str,
                        const YYSTYPE &result = YYSTYPE());
   CPPToken expand_manifest(const CPPManifest *manifest, const YYLTYPE &loc);
+  void lex_manifest_tokens(const CPPManifest *manifest);
+  bool lex_expansion(const std::string &expanded,
+                     std::vector<CPPToken> &tokens);
+  bool push_expansion_args(const CPPManifest *manifest,
+                           const vector_string &args,
+                           const CPPManifest::Ignores &ignores,
+                           const YYLTYPE &loc);
+  bool can_replay_tokens(const CPPManifest *manifest,
+                         CPPManifest::Ignores &checked);
   void r_expand_manifests(std::string &expr, bool expand_undefined,
                           const YYLTYPE &loc, std::set<const CPPManifest *> &expanded);
   void extract_manifest_args(const std::string &name, int num_args,
@@ -170,6 +193,8 @@ private:
   std::string scan_quoted(int c);
   std::string scan_raw(int c);
 
+  void add_comment(CPPCommentBlock *comment);
+
   bool should_ignore_manifest(const CPPManifest *manifest) const;
   bool should_ignore_preprocessor() const;
 
@@ -192,13 +217,20 @@ private:
 
     bool open(const CPPFile &file);
     bool connect_input(const std::string &input);
+    void set_buffer();
     int get();
     int peek();
+    std::string get_input() const;
 
     const CPPManifest *_manifest;
     CPPFile _file;
+
+    // The entire contents of the file or string are held in _input; _ptr
+    // points at the next character to be returned, and _end one past the
+    // last character.
     std::string _input;
-    std::istream *_in;
+    const char *_ptr;
+    const char *_end;
     int _line_number;
     int _col_number;
     int _next_line_number;
@@ -207,6 +239,34 @@ private:
     bool _ignore_manifest;
     int _prev_last_c;
 
+    // Tracks whether the file consists of a single #ifndef ... #endif block
+    // (ignoring comments and whitespace), in which case _guard_macro is the
+    // name of the macro controlling it.
+    enum GuardState {
+      GS_start, GS_in_guard, GS_after_guard, GS_none
+    };
+    GuardState _guard_state;
+    std::string _guard_macro;
+    int _if_depth;
+
+    // If this is the expansion of a manifest whose tokens are cached, or a
+    // token stream loaded from a snapshot, these are replayed instead of
+    // reading characters from _input.  A snapshot stream also supplies the
+    // comments that were read along with the tokens.
+    const std::vector<CPPToken> *_tokens;
+    size_t _next_token;
+
+    // For the cached expansion of a manifest taking parameters, the arguments
+    // and their tokens, and for each of the cached tokens, the argument to
+    // be replayed in its place, or -1.  The tokens of an argument are
+    // replayed by a nested InputFile, for which _argument is set.
+    vector_string _args;
+    std::vector<std::vector<CPPToken> > _arg_tokens;
+    const std::vector<int> *_token_params;
+    bool _argument;
+    const CPPSnapshot::Comments *_comments;
+    size_t _next_comment;
+
     InputFile *_parent = nullptr;
   };
 
@@ -229,6 +289,11 @@ private:
 
   std::vector<CPPToken> _saved_tokens;
 
+  // The comments in _comments, grouped by the file they appear in.
+  typedef std::vector<CPPCommentBlock *> CommentIndex;
+  typedef std::map<CPPFile, CommentIndex> FileComments;
+  FileComments _file_comments;
+
   mutable int _warning_count;
   mutable int _error_count;
   bool _error_abort;
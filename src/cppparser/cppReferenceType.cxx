@@ -305,3 +305,12 @@ is_less(const CPPDeclaration *other) const {
 
   return _pointing_at < ot->_pointing_at;
 }
+
+/**
+ * Hashes the value category and the type being referenced.
+ */
+size_t CPPReferenceType::
+compute_hash() const {
+  size_t hash = combine_hash((size_t)get_subtype(), (size_t)_value_category);
+  return combine_hash(hash, std::hash<const void *>()(_pointing_at));
+}
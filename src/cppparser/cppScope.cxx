@@ -137,6 +137,7 @@ add_enum_value(CPPInstance *inst) {
   string name = inst->get_simple_name();
   if (!name.empty()) {
     _enum_values[name] = inst;
+    add_name(name);
   }
 }
 
@@ -146,6 +147,7 @@ add_enum_value(CPPInstance *inst) {
 void CPPScope::
 define_typedef_type(CPPTypedefType *type, CPPPreprocessor *error_sink) {
   string name = type->get_simple_name();
+  add_name(name);
 
   pair<Types::iterator, bool> result =
     _types.insert(Types::value_type(name, type));
@@ -183,6 +185,7 @@ define_typedef_type(CPPTypedefType *type, CPPPreprocessor *error_sink) {
     }
 
     string simple_name = type->get_simple_name();
+    add_name(simple_name);
 
     pair<Templates::iterator, bool> result =
       _templates.insert(Templates::value_type(simple_name, type));
@@ -235,6 +238,7 @@ define_extension_type(CPPExtensionType *type, CPPPreprocessor *error_sink) {
 
   // Create an implicit typedef for the extension.  CPPTypedefType *td = new
   // CPPTypedefType(type, name);
+  add_name(name);
   pair<Types::iterator, bool> result =
     _types.insert(Types::value_type(name, type));
 
@@ -295,6 +299,7 @@ define_extension_type(CPPExtensionType *type, CPPPreprocessor *error_sink) {
     }
 
     string simple_name = type->get_simple_name();
+    add_name(simple_name);
 
     pair<Templates::iterator, bool> result =
       _templates.insert(Templates::value_type(simple_name, type));
@@ -322,6 +327,7 @@ define_namespace(CPPNamespace *ns) {
   string name = ns->get_simple_name();
 
   _namespaces[name] = ns;
+  add_name(name);
 
   if (ns->_is_inline) {
     // Add an implicit using declaration for an inline namespace.
@@ -472,9 +478,9 @@ instantiate(const CPPTemplateParameterList *actual_params,
         // CPPTypedefType *td = new CPPTypedefType(ctp, ctp->_ident);
         // scope->_typedefs.insert(Typedefs::value_type
         // (ctp->_ident->get_local_name(), td));
-        scope->_types.insert(Types::value_type
-                             (ctp->_ident->get_local_name(),
-                              ctp));
+        string name = ctp->_ident->get_local_name();
+        scope->_types.insert(Types::value_type(name, ctp));
+        scope->add_name(name);
       }
     }
   }
@@ -540,15 +546,31 @@ substitute_decl(CPPDeclaration::SubstDecl &subst,
  */
 CPPType *CPPScope::
 find_type(const string &name, bool recurse) const {
+  NameHandle handle = find_name_handle(name);
+  if (handle == nullptr) {
+    // No scope has ever declared anything by this name.
+    return nullptr;
+  }
+  return r_find_type(handle, recurse);
+}
+
+/**
+ *
+ */
+CPPType *CPPScope::
+find_type(const string &name, CPPDeclaration::SubstDecl &subst,
+          CPPScope *global_scope, bool recurse) const {
   Types::const_iterator ti;
   ti = _types.find(name);
   if (ti != _types.end()) {
-    return ti->second;
+    CPPScope *current_scope = (CPPScope *)this;
+    return (*ti).second->substitute_decl
+      (subst, current_scope, global_scope)->as_type();
   }
 
   Using::const_iterator ui;
   for (ui = _using.begin(); ui != _using.end(); ++ui) {
-    CPPType *type = (*ui)->find_type(name, false);
+    CPPType *type = (*ui)->find_type(name, subst, global_scope, false);
     if (type != nullptr) {
       return type;
     }
@@ -561,7 +583,8 @@ find_type(const string &name, bool recurse) const {
          ++di) {
       CPPStructType *st = (*di)._base->as_struct_type();
       if (st != nullptr) {
-        CPPType *type = st->_scope->find_type(name, false);
+        CPPType *type = st->_scope->find_type(name, subst, global_scope,
+                                              false);
         if (type != nullptr) {
           return type;
         }
@@ -570,7 +593,7 @@ find_type(const string &name, bool recurse) const {
   }
 
   if (recurse && _parent_scope != nullptr) {
-    return _parent_scope->find_type(name);
+    return _parent_scope->find_type(name, subst, global_scope);
   }
 
   return nullptr;
@@ -579,20 +602,129 @@ find_type(const string &name, bool recurse) const {
 /**
  *
  */
+CPPScope *CPPScope::
+find_scope(const string &name, CPPScope *global_scope, bool recurse) const {
+  NameHandle handle = find_name_handle(name);
+  if (handle == nullptr) {
+    return nullptr;
+  }
+  return r_find_scope(handle, global_scope, recurse);
+}
+
+/**
+ *
+ */
+CPPScope *CPPScope::
+find_scope(const string &name, CPPDeclaration::SubstDecl &subst,
+           CPPScope *global_scope, bool recurse) const {
+  CPPType *type = find_type(name, subst, global_scope, recurse);
+  if (type == nullptr) {
+    return nullptr;
+  }
+
+  // Resolve if this is a typedef or const.
+  while (type->get_subtype() == CPPDeclaration::ST_const ||
+         type->get_subtype() == CPPDeclaration::ST_typedef) {
+    if (type->as_typedef_type() != nullptr) {
+      type = type->as_typedef_type()->_type;
+    } else {
+      type = type->as_const_type()->_wrapped_around;
+    }
+  }
+
+  CPPStructType *st = type->as_struct_type();
+  if (st != nullptr) {
+    return st->_scope;
+  }
+
+  CPPEnumType *et = type->as_enum_type();
+  if (et != nullptr) {
+    return et->_scope;
+  }
+
+  return nullptr;
+}
+
+/**
+ *
+ */
+CPPDeclaration *CPPScope::
+find_symbol(const string &name, bool recurse) const {
+  // Even if the name was never declared, it may still be the name of one of
+  // the enclosing classes, so we can't give up early here.
+  return r_find_symbol(name, find_name_handle(name), recurse);
+}
+
+/**
+ *
+ */
+CPPDeclaration *CPPScope::
+find_template(const string &name, bool recurse) const {
+  NameHandle handle = find_name_handle(name);
+  if (handle == nullptr) {
+    return nullptr;
+  }
+  return r_find_template(handle, recurse);
+}
+
+/**
+ * Returns the pooled string for the indicated name, adding it to the pool if
+ * this is the first time it is seen.
+ */
+CPPScope::NameHandle CPPScope::
+get_name_handle(const string &name) {
+  return &*get_name_pool().insert(name).first;
+}
+
+/**
+ * Returns the pooled string for the indicated name, or nullptr if no scope
+ * has ever declared anything by this name.
+ */
+CPPScope::NameHandle CPPScope::
+find_name_handle(const string &name) {
+  NamePool &pool = get_name_pool();
+  NamePool::const_iterator it = pool.find(name);
+  if (it == pool.end()) {
+    return nullptr;
+  }
+  return &*it;
+}
+
+/**
+ * Returns the global pool of names that have been declared in any scope.
+ */
+CPPScope::NamePool &CPPScope::
+get_name_pool() {
+  static NamePool pool;
+  return pool;
+}
+
+/**
+ * Records that the indicated name is declared in this scope.  This must be
+ * called whenever something is added to any of the name maps, or the find_*
+ * methods will not be able to find it.
+ */
+void CPPScope::
+add_name(const string &name) {
+  _names.insert(get_name_handle(name));
+}
+
+/**
+ * The recursive implementation of find_type().
+ */
 CPPType *CPPScope::
-find_type(const string &name, CPPDeclaration::SubstDecl &subst,
-          CPPScope *global_scope, bool recurse) const {
-  Types::const_iterator ti;
-  ti = _types.find(name);
-  if (ti != _types.end()) {
-    CPPScope *current_scope = (CPPScope *)this;
-    return (*ti).second->substitute_decl
-      (subst, current_scope, global_scope)->as_type();
+r_find_type(NameHandle name, bool recurse) const {
+  if (_names.count(name)) {
+    Types::const_iterator ti;
+    ti = _types.find(*name);
+    if (ti != _types.end()) {
+      return ti->second;
+    }
   }
 
   Using::const_iterator ui;
   for (ui = _using.begin(); ui != _using.end(); ++ui) {
-    CPPType *type = (*ui)->find_type(name, subst, global_scope, false);
+    CPPType *type = (*ui)->r_find_type(name, false);
     if (type != nullptr) {
       return type;
     }
@@ -605,8 +737,7 @@ find_type(const string &name, CPPDeclaration::SubstDecl &subst,
          ++di) {
       CPPStructType *st = (*di)._base->as_struct_type();
       if (st != nullptr) {
-        CPPType *type = st->_scope->find_type(name, subst, global_scope,
-                                              false);
+        CPPType *type = st->_scope->r_find_type(name, false);
         if (type != nullptr) {
           return type;
         }
@@ -615,26 +746,32 @@ find_type(const string &name, CPPDeclaration::SubstDecl &subst,
   }
 
   if (recurse && _parent_scope != nullptr) {
-    return _parent_scope->find_type(name, subst, global_scope);
+    return _parent_scope->r_find_type(name, true);
   }
 
   return nullptr;
 }
 
 /**
- *
+ * The recursive implementation of find_scope().
  */
 CPPScope *CPPScope::
-find_scope(const string &name, CPPScope *global_scope, bool recurse) const {
-  Namespaces::const_iterator ni = _namespaces.find(name);
-  if (ni != _namespaces.end()) {
-    return (*ni).second->get_scope();
+r_find_scope(NameHandle name, CPPScope *global_scope, bool recurse) const {
+  bool declared_here = (_names.count(name) != 0);
+
+  if (declared_here) {
+    Namespaces::const_iterator ni = _namespaces.find(*name);
+    if (ni != _namespaces.end()) {
+      return (*ni).second->get_scope();
+    }
   }
 
   CPPType *type = nullptr;
 
-  Types::const_iterator ti;
-  ti = _types.find(name);
+  Types::const_iterator ti = _types.end();
+  if (declared_here) {
+    ti = _types.find(*name);
+  }
   if (ti != _types.end()) {
     type = (*ti).second;
     // Resolve if this is a typedef or const, or a TBD type.
@@ -662,7 +799,7 @@ find_scope(const string &name, CPPScope *global_scope, bool recurse) const {
          ++di) {
       CPPStructType *st = (*di)._base->as_struct_type();
       if (st != nullptr) {
-        type = st->_scope->find_type(name, false);
+        type = st->_scope->r_find_type(name, false);
       }
     }
   }
@@ -681,88 +818,57 @@ find_scope(const string &name, CPPScope *global_scope, bool recurse) const {
 
   Using::const_iterator ui;
   for (ui = _using.begin(); ui != _using.end(); ++ui) {
-    CPPScope *scope = (*ui)->find_scope(name, global_scope, false);
+    CPPScope *scope = (*ui)->r_find_scope(name, global_scope, false);
     if (scope != nullptr) {
       return scope;
     }
   }
 
   if (recurse && _parent_scope != nullptr) {
-    return _parent_scope->find_scope(name, global_scope);
+    return _parent_scope->r_find_scope(name, global_scope, true);
   }
 
   return nullptr;
 }
 
 /**
- *
- */
-CPPScope *CPPScope::
-find_scope(const string &name, CPPDeclaration::SubstDecl &subst,
-           CPPScope *global_scope, bool recurse) const {
-  CPPType *type = find_type(name, subst, global_scope, recurse);
-  if (type == nullptr) {
-    return nullptr;
-  }
-
-  // Resolve if this is a typedef or const.
-  while (type->get_subtype() == CPPDeclaration::ST_const ||
-         type->get_subtype() == CPPDeclaration::ST_typedef) {
-    if (type->as_typedef_type() != nullptr) {
-      type = type->as_typedef_type()->_type;
-    } else {
-      type = type->as_const_type()->_wrapped_around;
-    }
-  }
-
-  CPPStructType *st = type->as_struct_type();
-  if (st != nullptr) {
-    return st->_scope;
-  }
-
-  CPPEnumType *et = type->as_enum_type();
-  if (et != nullptr) {
-    return et->_scope;
-  }
-
-  return nullptr;
-}
-
-/**
- *
+ * The recursive implementation of find_symbol().  The handle is nullptr if
+ * the name has never been declared in any scope.
  */
 CPPDeclaration *CPPScope::
-find_symbol(const string &name, bool recurse) const {
+r_find_symbol(const string &name, NameHandle handle, bool recurse) const {
   if (_struct_type != nullptr && name == get_simple_name()) {
     return _struct_type;
   }
 
-  Functions::const_iterator fi;
-  fi = _functions.find(name);
-  if (fi != _functions.end()) {
-    return (*fi).second;
-  }
+  if (handle != nullptr && _names.count(handle)) {
+    Functions::const_iterator fi;
+    fi = _functions.find(name);
+    if (fi != _functions.end()) {
+      return (*fi).second;
+    }
 
-  Types::const_iterator ti;
-  ti = _types.find(name);
-  if (ti != _types.end()) {
-    return (*ti).second;
-  }
+    Types::const_iterator ti;
+    ti = _types.find(name);
+    if (ti != _types.end()) {
+      return (*ti).second;
+    }
 
-  Variables::const_iterator vi;
-  vi = _variables.find(name);
-  if (vi != _variables.end()) {
-    return (*vi).second;
-  }
+    Variables::const_iterator vi;
+    vi = _variables.find(name);
+    if (vi != _variables.end()) {
+      return (*vi).second;
+    }
 
-  vi = _enum_values.find(name);
-  if (vi != _enum_values.end()) {
-    return (*vi).second;
+    vi = _enum_values.find(name);
+    if (vi != _enum_values.end()) {
+      return (*vi).second;
+    }
   }
 
   Using::const_iterator ui;
   for (ui = _using.begin(); ui != _using.end(); ++ui) {
-    CPPDeclaration *decl = (*ui)->find_symbol(name, false);
+    CPPDeclaration *decl = (*ui)->r_find_symbol(name, handle, false);
     if (decl != nullptr) {
       return decl;
     }
@@ -775,7 +881,7 @@ find_symbol(const string &name, bool recurse) const {
          ++di) {
       CPPStructType *st = (*di)._base->as_struct_type();
       if (st != nullptr) {
-        CPPDeclaration *decl = st->_scope->find_symbol(name, false);
+        CPPDeclaration *decl = st->_scope->r_find_symbol(name, handle, false);
         if (decl != nullptr) {
           return decl;
         }
@@ -784,26 +890,28 @@ find_symbol(const string &name, bool recurse) const {
   }
 
   if (recurse && _parent_scope != nullptr) {
-    return _parent_scope->find_symbol(name);
+    return _parent_scope->r_find_symbol(name, handle, true);
   }
 
   return nullptr;
 }
 
 /**
- *
+ * The recursive implementation of find_template().
  */
 CPPDeclaration *CPPScope::
-find_template(const string &name, bool recurse) const {
-  Templates::const_iterator ti;
-  ti = _templates.find(name);
-  if (ti != _templates.end()) {
-    return (*ti).second;
+r_find_template(NameHandle name, bool recurse) const {
+  if (_names.count(name)) {
+    Templates::const_iterator ti;
+    ti = _templates.find(*name);
+    if (ti != _templates.end()) {
+      return (*ti).second;
+    }
   }
 
   Using::const_iterator ui;
   for (ui = _using.begin(); ui != _using.end(); ++ui) {
-    CPPDeclaration *decl = (*ui)->find_template(name, false);
+    CPPDeclaration *decl = (*ui)->r_find_template(name, false);
     if (decl != nullptr) {
       return decl;
     }
@@ -816,7 +924,7 @@ find_template(const string &name, bool recurse) const {
          ++di) {
       CPPStructType *st = (*di)._base->as_struct_type();
       if (st != nullptr) {
-        CPPDeclaration *decl = st->_scope->find_template(name, false);
+        CPPDeclaration *decl = st->_scope->r_find_template(name, false);
         if (decl != nullptr) {
           return decl;
         }
@@ -825,7 +933,7 @@ find_template(const string &name, bool recurse) const {
   }
 
   if (recurse && _parent_scope != nullptr) {
-    return _parent_scope->find_template(name);
+    return _parent_scope->r_find_template(name, true);
   }
 
   return nullptr;
@@ -961,6 +1069,9 @@ copy_substitute_decl(CPPScope *to_scope, CPPDeclaration::SubstDecl &subst,
                      CPPScope *global_scope) const {
   bool anything_changed = false;
 
+  // All of the names we declare will be copied to the new scope below.
+  to_scope->_names.insert(_names.begin(), _names.end());
+
   if (_struct_type != nullptr) {
     CPPScope *native_scope = nullptr;
     if (_struct_type->_ident != nullptr) {
@@ -1155,6 +1266,7 @@ handle_declaration(CPPDeclaration *decl, CPPScope *global_scope,
 
     string name = inst->get_simple_name();
     if (!name.empty() && inst->get_scope(this, global_scope) == this) {
+      add_name(name);
       if (inst->_type->as_function_type()) {
         // This is a function declaration; hence it gets added to the
         // _functions member.  But we must be careful to share common-named
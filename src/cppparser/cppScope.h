@@ -19,11 +19,13 @@
 #include "cppVisibility.h"
 #include "cppTemplateParameterList.h"
 #include "cppNameComponent.h"
+#include "cppArena.h"
 
 #include <vector>
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_set>
 
 class CPPType;
 class CPPDeclaration;
@@ -49,6 +51,9 @@ public:
            const CPPNameComponent &name, CPPVisibility starting_vis);
   virtual ~CPPScope();
 
+  inline void *operator new(size_t size) { return CPPArena::alloc_node<CPPScope>(size); }
+  inline void operator delete(void *ptr) { CPPArena::free_node(ptr); }
+
   void set_current_vis(CPPVisibility current_vis);
   CPPVisibility get_current_vis() const;
 
@@ -109,7 +114,27 @@ public:
   CPPTemplateScope *get_template_scope();
   virtual CPPTemplateScope *as_template_scope();
 
+protected:
+  // Every name that is declared in any scope is interned in a global pool,
+  // and is identified by a pointer to the pooled string.  This lets each
+  // scope keep a cheap hash set of the names it declares, which is checked
+  // before searching the individual maps.
+  typedef const std::string *NameHandle;
+  static NameHandle get_name_handle(const std::string &name);
+  static NameHandle find_name_handle(const std::string &name);
+  void add_name(const std::string &name);
+
 private:
+  typedef std::unordered_set<std::string> NamePool;
+  static NamePool &get_name_pool();
+
+  CPPType *r_find_type(NameHandle name, bool recurse) const;
+  CPPScope *r_find_scope(NameHandle name, CPPScope *global_scope,
+                         bool recurse) const;
+  CPPDeclaration *r_find_symbol(const std::string &name, NameHandle handle,
+                                bool recurse) const;
+  CPPDeclaration *r_find_template(NameHandle name, bool recurse) const;
+
   bool
   copy_substitute_decl(CPPScope *to_scope, CPPDeclaration::SubstDecl &subst,
                        CPPScope *global_scope) const;
@@ -153,6 +178,9 @@ private:
   typedef std::map<const CPPTemplateParameterList *, CPPScope *, CPPTPLCompare> Instantiations;
   Instantiations _instantiations;
 
+  typedef std::unordered_set<NameHandle> Names;
+  Names _names;
+
   bool _is_fully_specified;
   bool _fully_specified_known;
   bool _is_fully_specified_recursive_protect;
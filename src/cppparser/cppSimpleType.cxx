@@ -310,3 +310,12 @@ is_less(const CPPDeclaration *other) const {
   }
   return _flags < ot->_flags;
 }
+
+/**
+ * Hashes the fundamental type and its modifier flags.
+ */
+size_t CPPSimpleType::
+compute_hash() const {
+  size_t hash = combine_hash((size_t)get_subtype(), (size_t)_type);
+  return combine_hash(hash, (size_t)_flags);
+}
@@ -0,0 +1,438 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cppSnapshot.cxx
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#include "cppSnapshot.h"
+#include "cppExpression.h"
+#include "cppBison.h"
+
+#include <map>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+using std::string;
+
+// Bump this whenever the file format changes.  Snapshots are only meant to be
+// read back by the same build of interrogate that wrote them.
+static const char snapshot_magic[4] = { 'C', 'P', 'P', 'S' };
+static const uint32_t snapshot_version = 1;
+
+/**
+ * Assigns an index to each distinct file referenced by the snapshot, so that
+ * each token need only store the index.
+ */
+class CPPSnapshot::FileTable {
+public:
+  void add(const CPPFile &file);
+  uint32_t find(const CPPFile &file) const;
+
+  std::vector<CPPFile> _files;
+  std::map<CPPFile, uint32_t> _indices;
+};
+
+/**
+ *
+ */
+void CPPSnapshot::FileTable::
+add(const CPPFile &file) {
+  if (_indices.insert(std::make_pair(file, (uint32_t)_files.size())).second) {
+    _files.push_back(file);
+  }
+}
+
+/**
+ *
+ */
+uint32_t CPPSnapshot::FileTable::
+find(const CPPFile &file) const {
+  std::map<CPPFile, uint32_t>::const_iterator it = _indices.find(file);
+  assert(it != _indices.end());
+  return (*it).second;
+}
+
+/**
+ *
+ */
+static void
+write_uint32(std::ostream &out, uint32_t value) {
+  char data[4] = {
+    (char)(value & 0xff), (char)((value >> 8) & 0xff),
+    (char)((value >> 16) & 0xff), (char)((value >> 24) & 0xff),
+  };
+  out.write(data, 4);
+}
+
+/**
+ *
+ */
+static void
+write_uint64(std::ostream &out, uint64_t value) {
+  write_uint32(out, (uint32_t)value);
+  write_uint32(out, (uint32_t)(value >> 32));
+}
+
+/**
+ *
+ */
+static void
+write_string(std::ostream &out, const string &str) {
+  write_uint32(out, (uint32_t)str.size());
+  out.write(str.data(), str.size());
+}
+
+/**
+ *
+ */
+static bool
+read_uint32(std::istream &in, uint32_t &value) {
+  unsigned char data[4];
+  if (!in.read((char *)data, 4)) {
+    return false;
+  }
+  value = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+  return true;
+}
+
+/**
+ *
+ */
+static bool
+read_int32(std::istream &in, int &value) {
+  uint32_t uvalue;
+  if (!read_uint32(in, uvalue)) {
+    return false;
+  }
+  value = (int)(int32_t)uvalue;
+  return true;
+}
+
+/**
+ *
+ */
+static bool
+read_uint64(std::istream &in, uint64_t &value) {
+  uint32_t lo, hi;
+  if (!read_uint32(in, lo) || !read_uint32(in, hi)) {
+    return false;
+  }
+  value = lo | ((uint64_t)hi << 32);
+  return true;
+}
+
+/**
+ *
+ */
+static bool
+read_string(std::istream &in, string &str) {
+  uint32_t size;
+  if (!read_uint32(in, size)) {
+    return false;
+  }
+  str.resize(size);
+  return size == 0 || (bool)in.read(&str[0], size);
+}
+
+/**
+ *
+ */
+static void
+write_loc(std::ostream &out, const cppyyltype &loc, uint32_t file_index) {
+  write_uint32(out, file_index);
+  write_uint32(out, (uint32_t)loc.first_line);
+  write_uint32(out, (uint32_t)loc.first_column);
+  write_uint32(out, (uint32_t)loc.last_line);
+  write_uint32(out, (uint32_t)loc.last_column);
+}
+
+/**
+ *
+ */
+static bool
+read_loc(std::istream &in, cppyyltype &loc, const std::vector<CPPFile> &files) {
+  uint32_t file_index;
+  if (!read_uint32(in, file_index) || file_index >= files.size()) {
+    return false;
+  }
+  loc.file = files[file_index];
+  return read_int32(in, loc.first_line) && read_int32(in, loc.first_column) &&
+         read_int32(in, loc.last_line) && read_int32(in, loc.last_column);
+}
+
+/**
+ * Writes the snapshot to the indicated binary stream.  Returns true on
+ * success, false if the snapshot contains something that cannot be written.
+ *
+ * The files that were named explicitly on the command line are recorded as
+ * ordinary included files, since they will not be explicit in the run that
+ * reads the snapshot back.
+ */
+bool CPPSnapshot::
+write(std::ostream &out, const std::set<Filename> &explicit_files) const {
+  // First collect all of the files we reference.
+  FileTable files;
+  for (const CPPFile &file : _parsed_files) {
+    files.add(file);
+  }
+  for (const Stream &stream : _streams) {
+    for (const CPPToken &token : stream._tokens) {
+      files.add(token._lloc.file);
+    }
+    for (const auto &comment : stream._comments) {
+      files.add(comment.second->_file);
+    }
+  }
+  for (const Manifest &manifest : _manifests) {
+    files.add(manifest._loc.file);
+  }
+
+  out.write(snapshot_magic, 4);
+  write_uint32(out, snapshot_version);
+
+  write_uint32(out, (uint32_t)files._files.size());
+  for (const CPPFile &file : files._files) {
+    CPPFile::Source source = file._source;
+    if (source == CPPFile::S_local && explicit_files.count(file._filename)) {
+      source = CPPFile::S_alternate;
+    }
+    write_string(out, file._filename.get_fullpath());
+    write_string(out, file._filename_as_referenced.get_fullpath());
+    write_uint32(out, (uint32_t)source);
+  }
+
+  write_uint32(out, (uint32_t)_parsed_files.size());
+  for (const CPPFile &file : _parsed_files) {
+    write_uint32(out, files.find(file));
+    write_uint32(out, file._pragma_once);
+    write_string(out, file._include_guard);
+  }
+
+  write_uint32(out, (uint32_t)_streams.size());
+  for (const Stream &stream : _streams) {
+    write_uint32(out, (uint32_t)stream._tokens.size());
+    for (const CPPToken &token : stream._tokens) {
+      write_uint32(out, (uint32_t)token._token);
+      write_loc(out, token._lloc, files.find(token._lloc.file));
+      write_string(out, token._lval.str);
+
+      switch (token._token) {
+      case INTEGER:
+      case CHAR_TOK:
+        write_uint64(out, token._lval.u.integer);
+        break;
+
+      case REAL:
+        {
+          // Snapshots aren't portable between builds anyway, so we can store
+          // the native representation.
+          char data[sizeof(long double)];
+          memset(data, 0, sizeof(data));
+          memcpy(data, &token._lval.u.real, sizeof(long double));
+          out.write(data, sizeof(data));
+        }
+        break;
+
+      case STRING_LITERAL:
+        write_uint32(out, (uint32_t)token._lval.u.expr->_type);
+        write_string(out, token._lval.u.expr->_str);
+        break;
+
+      case CUSTOM_LITERAL:
+        // This refers to the literal operator, which we have no way to
+        // record.
+        return false;
+      }
+    }
+
+    write_uint32(out, (uint32_t)stream._comments.size());
+    for (const auto &comment : stream._comments) {
+      const CPPCommentBlock *block = comment.second;
+      write_uint32(out, (uint32_t)comment.first);
+      write_uint32(out, files.find(block->_file));
+      write_uint32(out, (uint32_t)block->_line_number);
+      write_uint32(out, (uint32_t)block->_col_number);
+      write_uint32(out, (uint32_t)block->_last_line);
+      write_uint32(out, block->_c_style);
+      write_string(out, block->_comment);
+    }
+  }
+
+  write_uint32(out, (uint32_t)_manifests.size());
+  for (const Manifest &manifest : _manifests) {
+    write_string(out, manifest._definition);
+    write_loc(out, manifest._loc, files.find(manifest._loc.file));
+    write_uint32(out, (uint32_t)manifest._vis);
+  }
+
+  return !out.fail();
+}
+
+/**
+ * Reads a snapshot previously written by write().  Returns true on success,
+ * false if the stream does not contain a valid snapshot.  Any of the
+ * indicated explicit files that appear in the snapshot are marked S_local, as
+ * they would have been if they had been included normally.
+ */
+bool CPPSnapshot::
+read(std::istream &in, const std::set<Filename> &explicit_files) {
+  char magic[4];
+  uint32_t version;
+  if (!in.read(magic, 4) || memcmp(magic, snapshot_magic, 4) != 0 ||
+      !read_uint32(in, version) || version != snapshot_version) {
+    return false;
+  }
+
+  uint32_t num_files;
+  if (!read_uint32(in, num_files)) {
+    return false;
+  }
+  std::vector<CPPFile> files;
+  files.reserve(num_files);
+  for (uint32_t i = 0; i < num_files; ++i) {
+    string filename, filename_as_referenced;
+    uint32_t source;
+    if (!read_string(in, filename) ||
+        !read_string(in, filename_as_referenced) ||
+        !read_uint32(in, source) || source > CPPFile::S_none) {
+      return false;
+    }
+    if (explicit_files.count(filename)) {
+      source = CPPFile::S_local;
+    }
+    files.push_back(CPPFile(filename, filename_as_referenced,
+                            (CPPFile::Source)source));
+  }
+
+  uint32_t num_parsed_files;
+  if (!read_uint32(in, num_parsed_files)) {
+    return false;
+  }
+  _parsed_files.clear();
+  for (uint32_t i = 0; i < num_parsed_files; ++i) {
+    uint32_t file_index, pragma_once;
+    string include_guard;
+    if (!read_uint32(in, file_index) || file_index >= files.size() ||
+        !read_uint32(in, pragma_once) || !read_string(in, include_guard)) {
+      return false;
+    }
+    CPPFile file = files[file_index];
+    file._pragma_once = (pragma_once != 0);
+    file._include_guard = std::move(include_guard);
+    _parsed_files.push_back(std::move(file));
+  }
+
+  uint32_t num_streams;
+  if (!read_uint32(in, num_streams)) {
+    return false;
+  }
+  _streams.clear();
+  _streams.resize(num_streams);
+  for (Stream &stream : _streams) {
+    uint32_t num_tokens;
+    if (!read_uint32(in, num_tokens)) {
+      return false;
+    }
+    stream._tokens.reserve(num_tokens);
+    for (uint32_t i = 0; i < num_tokens; ++i) {
+      uint32_t token_type;
+      YYLTYPE loc;
+      string str;
+      YYSTYPE lval;
+      if (!read_uint32(in, token_type) || !read_loc(in, loc, files) ||
+          !read_string(in, str)) {
+        return false;
+      }
+
+      switch (token_type) {
+      case INTEGER:
+      case CHAR_TOK:
+        {
+          uint64_t value;
+          if (!read_uint64(in, value)) {
+            return false;
+          }
+          lval.u.integer = value;
+        }
+        break;
+
+      case REAL:
+        {
+          char data[sizeof(long double)];
+          if (!in.read(data, sizeof(data))) {
+            return false;
+          }
+          memcpy(&lval.u.real, data, sizeof(long double));
+        }
+        break;
+
+      case STRING_LITERAL:
+        {
+          uint32_t type;
+          string str;
+          if (!read_uint32(in, type) || !read_string(in, str)) {
+            return false;
+          }
+          lval.u.expr = new CPPExpression(str);
+          lval.u.expr->_type = (CPPExpression::Type)type;
+        }
+        break;
+
+      default:
+        lval.u.identifier = nullptr;
+        break;
+      }
+
+      stream._tokens.push_back(CPPToken((int)token_type, loc, str, lval));
+    }
+
+    uint32_t num_comments;
+    if (!read_uint32(in, num_comments)) {
+      return false;
+    }
+    stream._comments.reserve(num_comments);
+    for (uint32_t i = 0; i < num_comments; ++i) {
+      uint32_t index, file_index, c_style;
+      CPPCommentBlock *block = new CPPCommentBlock;
+      if (!read_uint32(in, index) ||
+          !read_uint32(in, file_index) || file_index >= files.size() ||
+          !read_int32(in, block->_line_number) ||
+          !read_int32(in, block->_col_number) ||
+          !read_int32(in, block->_last_line) ||
+          !read_uint32(in, c_style) || !read_string(in, block->_comment)) {
+        delete block;
+        return false;
+      }
+      block->_file = files[file_index];
+      block->_c_style = (c_style != 0);
+      stream._comments.push_back(std::make_pair((size_t)index, block));
+    }
+  }
+
+  uint32_t num_manifests;
+  if (!read_uint32(in, num_manifests)) {
+    return false;
+  }
+  _manifests.clear();
+  _manifests.resize(num_manifests);
+  for (Manifest &manifest : _manifests) {
+    uint32_t vis;
+    if (!read_string(in, manifest._definition) ||
+        manifest._definition.empty() ||
+        !read_loc(in, manifest._loc, files) ||
+        !read_uint32(in, vis) || vis > V_unknown) {
+      return false;
+    }
+    manifest._vis = (CPPVisibility)vis;
+  }
+
+  return true;
+}
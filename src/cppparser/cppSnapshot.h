@@ -0,0 +1,69 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cppSnapshot.h
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#ifndef CPPSNAPSHOT_H
+#define CPPSNAPSHOT_H
+
+//#include "dtoolbase.h"
+
+#include "cppToken.h"
+#include "cppFile.h"
+#include "cppVisibility.h"
+#include "cppCommentBlock.h"
+
+#include <vector>
+#include <set>
+#include <iostream>
+
+/**
+ * This records the result of preprocessing a set of header files, so that a
+ * later run can pick up where this one left off without having to read and
+ * preprocess those headers again.  It stores the preprocessed token stream of
+ * each file that was parsed (which is replayed into the parser), along with
+ * the comments, the macros that remain defined afterwards, and the list of
+ * files that were read.
+ */
+class CPPSnapshot {
+public:
+  typedef std::vector<std::pair<size_t, CPPCommentBlock *> > Comments;
+
+  // The tokens read by one call to CPPParser::parse_file().  Each comment is
+  // paired with the index of the token that was being read at the time.
+  class Stream {
+  public:
+    std::vector<CPPToken> _tokens;
+    Comments _comments;
+  };
+  typedef std::vector<Stream> Streams;
+  Streams _streams;
+
+  class Manifest {
+  public:
+    std::string _definition;
+    cppyyltype _loc;
+    CPPVisibility _vis;
+  };
+  typedef std::vector<Manifest> Manifests;
+  Manifests _manifests;
+
+  typedef std::vector<CPPFile> ParsedFiles;
+  ParsedFiles _parsed_files;
+
+  bool write(std::ostream &out, const std::set<Filename> &explicit_files) const;
+  bool read(std::istream &in, const std::set<Filename> &explicit_files);
+
+private:
+  class FileTable;
+};
+
+#endif
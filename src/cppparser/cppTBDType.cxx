@@ -173,3 +173,15 @@ is_less(const CPPDeclaration *other) const {
 
   return (*_ident) < (*ot->_ident);
 }
+
+/**
+ * Hashes the name of the type to be determined.
+ */
+size_t CPPTBDType::
+compute_hash() const {
+  size_t hash = (size_t)get_subtype();
+  for (const CPPNameComponent &name : _ident->_names) {
+    hash = combine_hash(hash, std::hash<std::string>()(name.get_name()));
+  }
+  return hash;
+}
@@ -33,6 +33,9 @@ class CPPTemplateParameterList {
 public:
   CPPTemplateParameterList();
 
+  inline void *operator new(size_t size) { return CPPArena::alloc_node<CPPTemplateParameterList>(size); }
+  inline void operator delete(void *ptr) { CPPArena::free_node(ptr); }
+
   std::string get_string() const;
   void build_subst_decl(const CPPTemplateParameterList &formal_params,
                         CPPDeclaration::SubstDecl &subst,
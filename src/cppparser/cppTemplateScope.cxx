@@ -102,6 +102,7 @@ add_template_parameter(CPPDeclaration *param) {
     if (cl->_ident != nullptr) {
       string name = cl->_ident->get_local_name();
       _types[name] = cl;
+      add_name(name);
     }
   }
 
@@ -111,6 +112,7 @@ add_template_parameter(CPPDeclaration *param) {
     string name = inst->get_local_name();
     if (!name.empty()) {
       _variables[name] = inst;
+      add_name(name);
     }
   }
 }
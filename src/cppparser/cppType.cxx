@@ -19,16 +19,26 @@
 #include "cppTypedefType.h"
 #include "cppExtensionType.h"
 #include <algorithm>
+#include <functional>
 
 using std::string;
 
-CPPType::Types CPPType::_types;
 CPPType::PreferredNames CPPType::_preferred_names;
 CPPType::AltNames CPPType::_alt_names;
 
-bool CPPTypeCompare::
-operator () (CPPType *a, CPPType *b) const {
-  return (*a) < (*b);
+size_t CPPTypeHash::
+operator () (const CPPType *type) const {
+  return type->get_hash();
+}
+
+/**
+ * Two types are considered the same if neither sorts before the other.  This
+ * is deliberately weaker than operator ==, since some types (like typedefs)
+ * are compared structurally by is_equal() but by identity by is_less().
+ */
+bool CPPTypeEqual::
+operator () (const CPPType *a, const CPPType *b) const {
+  return !((*a) < (*b)) && !((*b) < (*a));
 }
 
 /**
@@ -42,6 +52,34 @@ CPPType(const CPPFile &file) :
 
   // This is set true by interrogate when the "forcetype" keyword is used.
   _forcetype = false;
+  _hash = 0;
+}
+
+/**
+ * The cached hash is not copied, since the copy is usually modified before
+ * it is passed to new_type().
+ */
+CPPType::
+CPPType(const CPPType &copy) :
+  CPPDeclaration(copy),
+  _typedefs(copy._typedefs),
+  _declaration(copy._declaration),
+  _forcetype(copy._forcetype),
+  _hash(0)
+{
+}
+
+/**
+ * As with the copy constructor, the cached hash is reset rather than copied.
+ */
+CPPType &CPPType::
+operator = (const CPPType &copy) {
+  CPPDeclaration::operator = (copy);
+  _typedefs = copy._typedefs;
+  _declaration = copy._declaration;
+  _forcetype = copy._forcetype;
+  _hash = 0;
+  return *this;
 }
 
 /**
@@ -464,6 +502,19 @@ as_type() {
 }
 
 
+/**
+ * Returns a hash value that is consistent with the ordering defined by
+ * operator <, ie. two types that are not ordered relative to each other will
+ * return the same hash value.  The value is computed on first use and cached.
+ */
+size_t CPPType::
+get_hash() const {
+  if (_hash == 0) {
+    _hash = compute_hash();
+  }
+  return _hash;
+}
+
 /**
  * This should be called whenever a new CPPType object is created.  It will
  * uniquify the type pointers by checking to see if some equivalent CPPType
@@ -472,7 +523,7 @@ as_type() {
  */
 CPPType *CPPType::
 new_type(CPPType *type) {
-  std::pair<Types::iterator, bool> result = _types.insert(type);
+  std::pair<Types::iterator, bool> result = get_types().insert(type);
   if (result.second) {
     // The insertion has taken place; thus, this is the first time this type
     // has been declared.
@@ -482,7 +533,8 @@ new_type(CPPType *type) {
 
   // If this triggers, we probably messed up by defining is_less()
   // incorrectly; they provide a relative ordering even though they are equal
-  // to each other.  Or, we provided an is_equal() that gives false negatives.
+  // to each other.  Or, we provided an is_equal() that gives false negatives,
+  // or a compute_hash() that does not agree with is_less().
   assert(**result.first == *type);
 
   // The insertion has not taken place; thus, there was previously another
@@ -497,6 +549,57 @@ new_type(CPPType *type) {
   return *result.first;
 }
 
+/**
+ * Removes the types that were allocated from the indicated arena from the
+ * table used by new_type(), so that the arena may be destroyed.
+ */
+void CPPType::
+release_types(CPPArena *arena) {
+  Types &types = get_types();
+  Types::iterator ti = types.begin();
+  while (ti != types.end()) {
+    CPPType *type = *ti;
+    if (CPPArena::get_node_arena(dynamic_cast<void *>(type)) == arena) {
+      ti = types.erase(ti);
+    } else {
+      if (type->_declaration != nullptr &&
+          CPPArena::get_node_arena(dynamic_cast<void *>(type->_declaration)) == arena) {
+        type->_declaration = nullptr;
+      }
+      ++ti;
+    }
+  }
+}
+
+/**
+ * Returns the table of unique types used by new_type().  This is constructed
+ * on first use, so that it outlives any global parser that fills it.
+ */
+CPPType::Types &CPPType::
+get_types() {
+  static Types types;
+  return types;
+}
+
+/**
+ * Computes the hash value returned by get_hash().  Types that are compared
+ * by identity use the default implementation, which hashes the pointer;
+ * types that override is_less() to compare structurally should override this
+ * to hash the same properties.
+ */
+size_t CPPType::
+compute_hash() const {
+  return combine_hash((size_t)get_subtype(), std::hash<const void *>()(this));
+}
+
+/**
+ * Mixes the indicated value into the hash value, and returns the result.
+ */
+size_t CPPType::
+combine_hash(size_t hash, size_t value) {
+  return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+}
+
 /**
  * Records a global typedef name associated with the indicated Type.  This
  * will be an "alt" name, and it may also become the "preferred" name.
@@ -19,16 +19,23 @@
 #include "cppDeclaration.h"
 
 #include <set>
+#include <unordered_set>
 
 class CPPType;
 class CPPTypedefType;
 class CPPTypeDeclaration;
 
 
-// This is an STL function object used to uniquely order CPPType pointers.
-class CPPTypeCompare {
+// These are STL function objects used to hash and compare CPPType pointers
+// for the purpose of uniquifying them in new_type().
+class CPPTypeHash {
 public:
-  bool operator () (CPPType *a, CPPType *b) const;
+  size_t operator () (const CPPType *type) const;
+};
+
+class CPPTypeEqual {
+public:
+  bool operator () (const CPPType *a, const CPPType *b) const;
 };
 
 /**
@@ -40,6 +47,8 @@ public:
   Typedefs _typedefs;
 
   CPPType(const CPPFile &file);
+  CPPType(const CPPType &copy);
+  CPPType &operator = (const CPPType &copy);
 
   virtual CPPType *resolve_type(CPPScope *current_scope,
                                 CPPScope *global_scope);
@@ -94,7 +103,9 @@ public:
   virtual CPPType *as_type();
 
 
+  size_t get_hash() const;
   static CPPType *new_type(CPPType *type);
+  static void release_types(CPPArena *arena);
 
   static void record_alt_name_for(const CPPType *type, const std::string &name);
   static std::string get_preferred_name_for(const CPPType *type);
@@ -103,8 +114,11 @@ public:
   bool _forcetype;
 
 protected:
-  typedef std::set<CPPType *, CPPTypeCompare> Types;
-  static Types _types;
+  virtual size_t compute_hash() const;
+  static size_t combine_hash(size_t hash, size_t value);
+
+  typedef std::unordered_set<CPPType *, CPPTypeHash, CPPTypeEqual> Types;
+  static Types &get_types();
 
   typedef std::map<std::string, std::string> PreferredNames;
   static PreferredNames _preferred_names;
@@ -112,6 +126,10 @@ protected:
   typedef std::vector<std::string> Names;
   typedef std::map<std::string, Names> AltNames;
   static AltNames _alt_names;
+
+private:
+  // Caches the result of compute_hash(); 0 means not yet computed.
+  mutable size_t _hash;
 };
 
 #endif
@@ -34,6 +34,7 @@
 #include "cppParameterList.h"
 #include "cppReferenceType.h"
 #include "lineStream.h"
+#include "string_utils.h"
 
 #include <algorithm>
 #include <map>
@@ -894,33 +895,19 @@ write_prototypes(ostream &out_code, ostream *out_h) {
       // Forward declare where we will put the scoped enum type.
       string class_name = object->_itype._cpptype->get_local_name(&parser);
       string safe_name = make_safe_name(class_name);
-      out_code << "static PyTypeObject *Dtool_Ptr_" << safe_name << " = nullptr;\n";
-    }
-  }
-
-  out_code << "/**\n";
-  out_code << " * Declarations for exported classes\n";
-  out_code << " */\n";
-
-  out_code << "static const Dtool_TypeDef exports[] = {\n";
-
-  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
-    Object *object = (*oi).second;
-
-    if (object->_itype.is_class() || object->_itype.is_struct()) {
-      CPPType *type = object->_itype._cpptype;
-
-      if (isExportThisRun(type) && is_cpp_type_legal(type)) {
-        string class_name = type->get_local_name(&parser);
-        string safe_name = make_safe_name(class_name);
-
-        out_code << "  {\"" << class_name << "\", &Dtool_" << safe_name << "},\n";
+      if (_split_output) {
+        out_code << "extern PyTypeObject *Dtool_Ptr_" << safe_name << ";\n";
+      } else {
+        out_code << "static PyTypeObject *Dtool_Ptr_" << safe_name << " = nullptr;\n";
       }
     }
   }
 
-  out_code << "  {nullptr, nullptr},\n";
-  out_code << "};\n\n";
+  if (!_split_output) {
+    // When the wrappers are split, the table is written along with the rest
+    // of the module support code instead.
+    write_exports(out_code);
+  }
 
   out_code << "/**\n";
   out_code << " * Extern declarations for imported classes\n";
@@ -928,28 +915,33 @@ write_prototypes(ostream &out_code, ostream *out_h) {
 
   // Write out a table of the externally imported types that will be filled in
   // upon module initialization.
-  std::vector<CPPType *> ext_imports(_external_imports.begin(), _external_imports.end());
+  std::vector<CPPType *> ext_imports;
+  get_sorted_imports(ext_imports);
   if (!ext_imports.empty()) {
     out_code << "#ifndef LINK_ALL_STATIC\n";
-    out_code << "static Dtool_TypeDef imports[] = {\n";
-
-    // Ensure that there is a deterministic ordering of external imports.
-    std::sort(ext_imports.begin(), ext_imports.end(),
-              [] (const CPPType *a, const CPPType *b) {
-      return a->get_local_name(&parser) < b->get_local_name(&parser);
-    });
+    if (_split_output) {
+      // The table itself is defined in the main file; all of the other files
+      // refer to it by name.
+      out_code << "extern Dtool_TypeDef " << get_imports_name() << "[];\n";
+    } else {
+      out_code << "static Dtool_TypeDef " << get_imports_name() << "[] = {\n";
+    }
 
     int idx = 0;
     for (CPPType *type : ext_imports) {
       string class_name = type->get_local_name(&parser);
       string safe_name = make_safe_name(class_name);
 
-      out_code << "  {\"" << class_name << "\", nullptr},\n";
-      out_code << "#define Dtool_Ptr_" << safe_name << " (imports[" << idx << "].type)\n";
+      if (!_split_output) {
+        out_code << "  {\"" << class_name << "\", nullptr},\n";
+      }
+      out_code << "#define Dtool_Ptr_" << safe_name << " (" << get_imports_name() << "[" << idx << "].type)\n";
       ++idx;
     }
-    out_code << "  {nullptr, nullptr},\n";
-    out_code << "};\n";
+    if (!_split_output) {
+      out_code << "  {nullptr, nullptr},\n";
+      out_code << "};\n";
+    }
     out_code << "#endif\n\n";
   }
 
@@ -1018,6 +1010,65 @@ write_prototypes(ostream &out_code, ostream *out_h) {
   }
 }
 
+/**
+ * Writes out the table of classes that are exported by this module.
+ */
+void InterfaceMakerPythonNative::
+write_exports(ostream &out) {
+  out << "/**\n";
+  out << " * Declarations for exported classes\n";
+  out << " */\n";
+
+  out << "static const Dtool_TypeDef exports[] = {\n";
+
+  Objects::iterator oi;
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    Object *object = (*oi).second;
+
+    if (object->_itype.is_class() || object->_itype.is_struct()) {
+      CPPType *type = object->_itype._cpptype;
+
+      if (isExportThisRun(type) && is_cpp_type_legal(type)) {
+        string class_name = type->get_local_name(&parser);
+        string safe_name = make_safe_name(class_name);
+
+        out << "  {\"" << class_name << "\", &Dtool_" << safe_name << "},\n";
+      }
+    }
+  }
+
+  out << "  {nullptr, nullptr},\n";
+  out << "};\n\n";
+}
+
+/**
+ * Fills the indicated vector with the externally imported types, in a
+ * deterministic order.  This determines the index of each type in the imports
+ * table.
+ */
+void InterfaceMakerPythonNative::
+get_sorted_imports(std::vector<CPPType *> &result) const {
+  result.assign(_external_imports.begin(), _external_imports.end());
+
+  std::sort(result.begin(), result.end(),
+            [] (const CPPType *a, const CPPType *b) {
+    return a->get_local_name(&parser) < b->get_local_name(&parser);
+  });
+}
+
+/**
+ * Returns the name of the table of imported types.  This needs a unique name
+ * if it is shared between several generated files.
+ */
+string InterfaceMakerPythonNative::
+get_imports_name() const {
+  if (_split_output) {
+    return "Dtool_" + make_safe_name(_def->library_name) + "_imports";
+  } else {
+    return "imports";
+  }
+}
+
 /**
  * Output enough enformation to a declartion of a externally generated dtool
  * type object
@@ -1110,6 +1161,98 @@ write_functions(ostream &out) {
   }
 }
 
+/**
+ * A variant of write_functions() that distributes the class wrappers across
+ * several output files, so that they may be compiled in parallel.  The global
+ * functions are written to out, which is also used as the first shard; each
+ * top-level class is written along with its nested classes to whichever
+ * shard has received the least code so far.
+ *
+ * After this is called, write_prototypes() generates a header to be included
+ * by all of the shards, and write_module_support() must be written to out.
+ */
+void InterfaceMakerPythonNative::
+write_sharded_functions(ostream &out, const std::vector<ostream *> &shards) {
+  _split_output = true;
+
+  std::ostringstream globals;
+  globals << "/**\n";
+  globals << " * Python wrappers for global functions\n" ;
+  globals << " */\n";
+  FunctionsByIndex::iterator fi;
+  for (fi = _functions.begin(); fi != _functions.end(); ++fi) {
+    Function *func = (*fi).second;
+    if (!func->_itype.is_global() && is_function_legal(func)) {
+      write_function_for_top(globals, nullptr, func);
+    }
+  }
+
+  std::string globals_str = globals.str();
+  out << globals_str;
+
+  std::vector<ostream *> outs(1, &out);
+  outs.insert(outs.end(), shards.begin(), shards.end());
+  std::vector<size_t> sizes(outs.size(), 0);
+  sizes[0] = globals_str.size();
+
+  // Group each class with the outermost class it is nested in, since the
+  // outer class initializes its nested classes.  The groups are keyed by the
+  // index of the outermost class to keep the output deterministic.
+  typedef std::map<TypeIndex, std::vector<Object *> > Groups;
+  Groups groups;
+
+  InterrogateDatabase *idb = InterrogateDatabase::get_ptr();
+  Objects::iterator oi;
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    Object *object = (*oi).second;
+    if (object->_itype.is_class() || object->_itype.is_struct()) {
+      if (is_cpp_type_legal(object->_itype._cpptype)) {
+        if (isExportThisRun(object->_itype._cpptype)) {
+          TypeIndex outer = (*oi).first;
+          while (idb->get_type(outer).get_outer_class() != 0) {
+            outer = idb->get_type(outer).get_outer_class();
+          }
+          groups[outer].push_back(object);
+        }
+      }
+    }
+  }
+
+  Groups::iterator gi;
+  for (gi = groups.begin(); gi != groups.end(); ++gi) {
+    std::vector<Object *> &objects = (*gi).second;
+
+    std::ostringstream group;
+    for (Object *object : objects) {
+      write_class_definition(group, object);
+    }
+    group << "\n";
+
+    for (Object *object : objects) {
+      write_class_details(group, object);
+    }
+
+    // The outer class may not be in the group if it couldn't be exported, in
+    // which case write_functions() wouldn't write any of the module classes.
+    oi = _objects.find((*gi).first);
+    if (oi != _objects.end() &&
+        std::find(objects.begin(), objects.end(), (*oi).second) != objects.end()) {
+      write_module_class(group, (*oi).second);
+    }
+
+    // Send it to the smallest shard.
+    size_t best = 0;
+    for (size_t i = 1; i < sizes.size(); ++i) {
+      if (sizes[i] < sizes[best]) {
+        best = i;
+      }
+    }
+    std::string group_str = group.str();
+    *outs[best] << group_str;
+    sizes[best] += group_str.size();
+  }
+}
+
 /**
  * Writes out all of the wrapper methods necessary to export the given object.
  * This is called by write_functions.
@@ -1327,6 +1470,10 @@ write_class_details(ostream &out, Object *obj) {
     }
   }
 
+  if (has_vectorcall_constructor(obj)) {
+    write_vectorcall_constructor(out, obj);
+  }
+
   // If we have "coercion constructors", write a single wrapper to consolidate
   // those.
   int has_coerce = has_coerce_constructor(struct_type);
@@ -1366,11 +1513,31 @@ write_class_details(ostream &out, Object *obj) {
     out << "    return local_this;\n";
     out << "  }\n";
 
+    // Collect the types we can cast to, along with the expression that
+    // performs the cast.  The direct bases come first, since those are the
+    // ones most likely to be requested.
+    std::vector<std::pair<string, string> > upcasts;
+    std::set<string> upcast_names;
+
+    for (const CPPStructType::Base &base : struct_type->_derivation) {
+      CPPStructType *base_type = TypeManager::resolve_type(base._base)->as_struct_type();
+      if (base_type != nullptr) {
+        di = details.find(base_type->get_local_name(&parser));
+        if (di != details.end() && di->second._is_legal_py_class) {
+          string safe_name = make_safe_name(di->second._to_class_name);
+          if (upcast_names.insert(safe_name).second) {
+            upcasts.push_back(std::make_pair(safe_name, di->second._up_cast_string + " local_this"));
+          }
+        }
+      }
+    }
+
     for (di = details.begin(); di != details.end(); di++) {
       if (di->second._is_legal_py_class) {
-        out << "  if (requested_type == Dtool_Ptr_" << make_safe_name(di->second._to_class_name) << ") {\n";
-        out << "    return " << di->second._up_cast_string << " local_this;\n";
-        out << "  }\n";
+        string safe_name = make_safe_name(di->second._to_class_name);
+        if (upcast_names.insert(safe_name).second) {
+          upcasts.push_back(std::make_pair(safe_name, di->second._up_cast_string + " local_this"));
+        }
       }
     }
 
@@ -1386,15 +1553,44 @@ write_class_details(ostream &out, Object *obj) {
 
           CPPType *cast_type = remap->_return_type->get_orig_type();
           CPPType *obj_type = TypeManager::unwrap(TypeManager::resolve_type(remap->_return_type->get_new_type()));
-          string return_expr = "(" + cast_type->get_local_name(&parser) + ")*local_this";
-          out << "  // " << *remap->_cppfunc << "\n";
-          out << "  if (requested_type == Dtool_Ptr_" << make_safe_name(obj_type->get_local_name(&parser)) << ") {\n";
-          out << "    return (void *)(" << remap->_return_type->get_return_expr(return_expr) << ");\n";
-          out << "  }\n";
+          string safe_name = make_safe_name(obj_type->get_local_name(&parser));
+          if (upcast_names.insert(safe_name).second) {
+            string return_expr = "(" + cast_type->get_local_name(&parser) + ")*local_this";
+            upcasts.push_back(std::make_pair(safe_name, "(void *)(" + remap->_return_type->get_return_expr(return_expr) + ")"));
+          }
         }
       }
     }
 
+    if (!upcasts.empty()) {
+      // Look up the requested type in a table, remembering where we found it
+      // last time, so that repeated requests for the same type only need a
+      // single comparison.  The cache is only a hint, so relaxed atomic
+      // accesses suffice to keep this safe when the GIL is disabled.
+      out << "  static Dtool_PyTypedObject *const *const upcast_types[" << upcasts.size() << "] = {\n";
+      for (const std::pair<string, string> &upcast : upcasts) {
+        out << "    &Dtool_Ptr_" << upcast.first << ",\n";
+      }
+      out << "  };\n";
+      out << "  static std::atomic<int> upcast_cache(0);\n";
+      out << "  int index = upcast_cache.load(std::memory_order_relaxed);\n";
+      out << "  if (*upcast_types[index] != requested_type) {\n";
+      out << "    index = 0;\n";
+      out << "    while (*upcast_types[index] != requested_type) {\n";
+      out << "      if (++index >= " << upcasts.size() << ") {\n";
+      out << "        return nullptr;\n";
+      out << "      }\n";
+      out << "    }\n";
+      out << "    upcast_cache.store(index, std::memory_order_relaxed);\n";
+      out << "  }\n";
+      out << "  switch (index) {\n";
+      for (size_t i = 0; i < upcasts.size(); ++i) {
+        out << "  case " << i << ":\n";
+        out << "    return " << upcasts[i].second << ";\n";
+      }
+      out << "  }\n";
+    }
+
     out << "  return nullptr;\n";
     out << "}\n\n";
 
@@ -1420,7 +1616,7 @@ write_class_details(ostream &out, Object *obj) {
       out << "  PyObject *stored_self = to_this->__self__;\n";
       out << "  if (stored_self == nullptr) {\n";
       out << "    // Allocate a new Python instance\n";
-      out << "    Dtool_PyInstDef *self = (Dtool_PyInstDef *)PyType_GenericAlloc(&Dtool_" << ClassName << "._PyType, 0);\n";
+      out << "    Dtool_PyInstDef *self = Dtool_AllocInstance(Dtool_" << ClassName << ");\n";
       out << "    self->_signature = PY_PANDA_SIGNATURE;\n";
       out << "    self->_My_Type = &Dtool_" << ClassName << ";\n";
       out << "    self->_ptr_to_object = to_this;\n";
@@ -1435,7 +1631,7 @@ write_class_details(ostream &out, Object *obj) {
       out << "  return result;\n";
     } else {
       out << "  // Allocate a new Python instance\n";
-      out << "  Dtool_PyInstDef *self = (Dtool_PyInstDef *)PyType_GenericAlloc(&Dtool_" << ClassName << "._PyType, 0);\n";
+      out << "  Dtool_PyInstDef *self = Dtool_AllocInstance(Dtool_" << ClassName << ");\n";
       out << "  self->_signature = PY_PANDA_SIGNATURE;\n";
       out << "  self->_My_Type = &Dtool_" << ClassName << ";\n";
       out << "  self->_ptr_to_object = to_this;\n";
@@ -1463,26 +1659,17 @@ write_class_declarations(ostream &out, ostream *out_h, Object *obj) {
   // This typedef is necessary for class templates since we can't pass a comma
   // to a macro function.
   out << "typedef " << c_class_name << " " << class_name << "_localtype;\n";
-  if (obj->_itype.has_destructor() ||
-      obj->_itype.destructor_is_inherited() ||
-      obj->_itype.destructor_is_implicit()) {
-
-    if (TypeManager::is_reference_count(type)) {
-      out << "Define_Module_ClassRef";
-    } else {
-      out << "Define_Module_Class";
-    }
+  if (_split_output) {
+    // The static functions defined by the macro are only needed in the file
+    // that contains the rest of the class; see write_class_definition().
+    out << "extern struct Dtool_PyTypedObject Dtool_" << class_name << ";\n";
+    out << "static struct Dtool_PyTypedObject *const Dtool_Ptr_" << class_name << " = &Dtool_" << class_name << ";\n";
+    out << "void Dtool_PyModuleClassInit_" << class_name << "(PyObject *module);\n";
   } else {
-    if (TypeManager::is_reference_count(type)) {
-      out << "Define_Module_ClassRef_Private";
-    } else {
-      out << "Define_Module_Class_Private";
-    }
+    write_class_definition(out, obj);
+    out << "static struct Dtool_PyTypedObject *const Dtool_Ptr_" << class_name << " = &Dtool_" << class_name << ";\n";
+    out << "static void Dtool_PyModuleClassInit_" << class_name << "(PyObject *module);\n";
   }
-  out << "(" << _def->module_name << ", " << class_name << ", " << class_name << "_localtype, " << classNameFromCppName(preferred_name, false) << ");\n";
-
-  out << "static struct Dtool_PyTypedObject *const Dtool_Ptr_" << class_name << " = &Dtool_" << class_name << ";\n";
-  out << "static void Dtool_PyModuleClassInit_" << class_name << "(PyObject *module);\n";
 
   int has_coerce = has_coerce_constructor(type->as_struct_type());
   if (has_coerce > 0) {
@@ -1503,6 +1690,36 @@ write_class_declarations(ostream &out, ostream *out_h, Object *obj) {
   }
 }
 
+/**
+ * Writes out the Define_Module_Class line for the indicated class, which
+ * declares the type object and defines the static new and free functions.
+ */
+void InterfaceMakerPythonNative::
+write_class_definition(ostream &out, Object *obj) {
+  std::string class_name = make_safe_name(obj->_itype.get_scoped_name());
+  std::string preferred_name = obj->_itype.get_name();
+
+  CPPType *type = obj->_itype._cpptype;
+
+  if (obj->_itype.has_destructor() ||
+      obj->_itype.destructor_is_inherited() ||
+      obj->_itype.destructor_is_implicit()) {
+
+    if (TypeManager::is_reference_count(type)) {
+      out << "Define_Module_ClassRef";
+    } else {
+      out << "Define_Module_Class";
+    }
+  } else {
+    if (TypeManager::is_reference_count(type)) {
+      out << "Define_Module_ClassRef_Private";
+    } else {
+      out << "Define_Module_Class_Private";
+    }
+  }
+  out << "(" << _def->module_name << ", " << class_name << ", " << class_name << "_localtype, " << classNameFromCppName(preferred_name, false) << ");\n";
+}
+
 /**
  * Generates whatever additional code is required to support a module file.
  */
@@ -1568,12 +1785,40 @@ write_sub_module(ostream &out, Object *obj) {
  */
 void InterfaceMakerPythonNative::
 write_module_support(ostream &out, ostream *out_h, InterrogateModuleDef *def) {
+  Objects::iterator oi;
+
+  if (_split_output) {
+    // These were only declared in the shared header.
+    for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+      Object *object = (*oi).second;
+      if (object->_itype.is_scoped_enum() && isExportThisRun(object->_itype._cpptype)) {
+        string class_name = object->_itype._cpptype->get_local_name(&parser);
+        string safe_name = make_safe_name(class_name);
+        out << "PyTypeObject *Dtool_Ptr_" << safe_name << " = nullptr;\n";
+      }
+    }
+    out << "\n";
+
+    write_exports(out);
+
+    std::vector<CPPType *> ext_imports;
+    get_sorted_imports(ext_imports);
+    if (!ext_imports.empty()) {
+      out << "#ifndef LINK_ALL_STATIC\n";
+      out << "Dtool_TypeDef " << get_imports_name() << "[] = {\n";
+      for (CPPType *type : ext_imports) {
+        out << "  {\"" << type->get_local_name(&parser) << "\", nullptr},\n";
+      }
+      out << "  {nullptr, nullptr},\n";
+      out << "};\n";
+      out << "#endif\n\n";
+    }
+  }
+
   out << "/**\n";
   out << " * Module Object Linker ..\n";
   out << " */\n";
 
-  Objects::iterator oi;
-
   out << "void Dtool_" << def->library_name << "_RegisterTypes() {\n"
          "  TypeRegistry *registry = TypeRegistry::ptr();\n"
          "  nassertv(registry != nullptr);\n";
@@ -1599,9 +1844,16 @@ write_module_support(ostream &out, ostream *out_h, InterrogateModuleDef *def) {
           out << "    TypeHandle handle = " << type->get_local_name(&parser)
               << "::get_class_type();\n";
           out << "    Dtool_" << safe_name << "._type = handle;\n";
-          out << "    registry->record_python_type(handle,"
-                 " &Dtool_" << safe_name << "._PyType,"
-                 " Dtool_Wrap_" << safe_name << ");\n";
+          if (_split_output) {
+            // The wrap function is static to the file containing the class.
+            out << "    registry->record_python_type(handle,"
+                   " &Dtool_" << safe_name << "._PyType,"
+                   " Dtool_" << safe_name << "._Dtool_WrapInterface);\n";
+          } else {
+            out << "    registry->record_python_type(handle,"
+                   " &Dtool_" << safe_name << "._PyType,"
+                   " Dtool_Wrap_" << safe_name << ");\n";
+          }
           out << "  }\n";
         } else {
           if (IsPandaTypedObject(type->as_struct_type())) {
@@ -1814,7 +2066,7 @@ write_module_support(ostream &out, ostream *out_h, InterrogateModuleDef *def) {
       "#ifdef LINK_ALL_STATIC\n"
       "extern const struct LibraryDef " << def->library_name << "_moddef = {python_simple_funcs, exports, nullptr, " << def_ptr << "};\n"
       "#else\n"
-      "extern const struct LibraryDef " << def->library_name << "_moddef = {python_simple_funcs, exports, imports, " << def_ptr << "};\n"
+      "extern const struct LibraryDef " << def->library_name << "_moddef = {python_simple_funcs, exports, " << get_imports_name() << ", " << def_ptr << "};\n"
       "#endif\n";
   }
   if (out_h != nullptr) {
@@ -2895,6 +3147,26 @@ write_module_class(ostream &out, Object *obj) {
       }
     }
 
+    // If the class is a vector of a simple numeric type, we can expose its
+    // contents via the buffer protocol without a __getbuffer__ method.
+    if (!has_local_getbuffer && slots.count("bf_releasebuffer") == 0) {
+      CPPType *element_type = TypeManager::get_vector_element_type(struct_type);
+      if (element_type != nullptr) {
+        string format = get_buffer_format(element_type);
+        if (!format.empty()) {
+          write_vector_getbuffer(out, obj, format);
+          has_local_getbuffer = true;
+
+          slots["bf_getbuffer"]._answer_location = "bf_getbuffer";
+          slots["bf_getbuffer"]._wrapper_type = WT_getbuffer;
+          slots["bf_getbuffer"]._wrapper_name = "Dtool_GetBuffer_" + ClassName;
+          slots["bf_releasebuffer"]._answer_location = "bf_releasebuffer";
+          slots["bf_releasebuffer"]._wrapper_type = WT_releasebuffer;
+          slots["bf_releasebuffer"]._wrapper_name = "Dtool_ReleaseVectorBuffer";
+        }
+      }
+    }
+
     int need_repr = 0;
     if (slots.count("tp_repr") == 0) {
       need_repr = NeedsAReprFunction(obj->_itype);
@@ -3193,6 +3465,14 @@ write_module_class(ostream &out, Object *obj) {
       if (!ielem.is_sequence() && !ielem.is_mapping() && !property->_setter_remaps.empty()) {
         setter = "&Dtool_" + ClassName + "_" + ielem.get_name() + "_Setter";
       }
+      string closure = "nullptr";
+      if (!get_member_type_code(obj, property).empty()) {
+        getter = "&Dtool_GetMember";
+        if (!property->_setter_remaps.empty()) {
+          setter = "&Dtool_SetMember";
+        }
+        closure = "(void *)&Dtool_" + ClassName + "_" + ielem.get_name() + "_MemberDef";
+      }
 
       out << "  {(char *)\"" << name1 << "\", " << getter << ", " << setter;
 
@@ -3204,8 +3484,8 @@ write_module_class(ostream &out, Object *obj) {
         out << ", nullptr, ";
       }
 
-      // Extra void* argument; we don't make use of it.
-      out << "nullptr},\n";
+      // Extra void* argument; only used for a Dtool_MemberDef.
+      out << closure << "},\n";
 
       /*if (name1 != name2 && name1 != "__dict__") {
         // Add alternative spelling.
@@ -3574,7 +3854,13 @@ write_module_class(ostream &out, Object *obj) {
   out << "    nullptr, // tp_finalize\n";
   out << "#endif\n";
   // vectorcallfunc tp_vectorcall
-  out << "#if PY_VERSION_HEX >= 0x03080000\n";
+  if (has_vectorcall_constructor(obj)) {
+    out << "#if PY_VERSION_HEX >= 0x03090000\n";
+    out << "    Dtool_VectorCall_" << ClassName << ",\n";
+    out << "#elif PY_VERSION_HEX >= 0x03080000\n";
+  } else {
+    out << "#if PY_VERSION_HEX >= 0x03080000\n";
+  }
   out << "    nullptr, // tp_vectorcall\n";
   out << "#endif\n";
   out << "  },\n";
@@ -3604,9 +3890,18 @@ write_module_class(ostream &out, Object *obj) {
     out << "  nullptr,\n";
   }
 
+  if (TypeManager::is_reference_count(struct_type)) {
+    out << "  Dtool_Unref_" << ClassName << ",\n";
+  } else {
+    out << "  nullptr,\n";
+  }
+
   out << "};\n\n";
 
-  out << "static void Dtool_PyModuleClassInit_" << ClassName << "(PyObject *module) {\n";
+  if (!_split_output) {
+    out << "static ";
+  }
+  out << "void Dtool_PyModuleClassInit_" << ClassName << "(PyObject *module) {\n";
   out << "  (void) module; // Unused\n";
   out << "  static bool initdone = false;\n";
   out << "  if (!initdone) {\n";
@@ -4783,6 +5078,152 @@ write_coerce_constructor(ostream &out, Object *obj, bool is_const) {
   out << "}\n\n";
 }
 
+/**
+ * Writes a tp_vectorcall implementation for the class, which is used by
+ * Python 3.9 and above when the class is called to construct a new instance.
+ * This bypasses type.__call__, which would otherwise pack the arguments into
+ * a new tuple and dict before invoking tp_new and tp_init.
+ *
+ * Since the constructor wrapper is written to take a tuple, the positional
+ * arguments are instead passed in a temporary tuple on the stack.  This is
+ * safe because the wrapper does nothing with the tuple other than unpack it.
+ */
+void InterfaceMakerPythonNative::
+write_vectorcall_constructor(ostream &out, Object *obj) {
+  std::string ClassName = make_safe_name(obj->_itype.get_scoped_name());
+
+  int max_num_args = 0;
+  for (Function *func : obj->_constructors) {
+    for (FunctionRemap *remap : func->_remaps) {
+      if (is_remap_legal(remap)) {
+        max_num_args = std::max(max_num_args, remap->get_max_num_args());
+      }
+    }
+  }
+
+  out << "#if PY_VERSION_HEX >= 0x03090000\n";
+  out << "static PyObject *Dtool_VectorCall_" << ClassName << "(PyObject *type, PyObject *const *args, size_t nargsf, PyObject *kwnames) {\n";
+  out << "  Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);\n";
+
+  // Keyword arguments are uncommon enough that we just let type.__call__
+  // handle those, as well as calls to construct a Python subclass.
+  out << "  if (type != (PyObject *)&Dtool_" << ClassName << " || nargs > " << max_num_args << " ||\n";
+  out << "      (kwnames != nullptr && PyTuple_GET_SIZE(kwnames) != 0)) {\n";
+  out << "    return Dtool_CallTypeGeneric(type, args, nargsf, kwnames);\n";
+  out << "  }\n";
+
+  if (max_num_args > 1) {
+    // PyTupleObject has room for one item, so we need to reserve space for
+    // the rest right after it.
+    out << "  struct {\n";
+    out << "    PyTupleObject tuple;\n";
+    out << "    PyObject *more_items[" << (max_num_args - 1) << "];\n";
+    out << "  } arg_tuple;\n";
+    out << "  PyObject *tuple = (PyObject *)&arg_tuple.tuple;\n";
+  } else {
+    out << "  PyTupleObject arg_tuple;\n";
+    out << "  PyObject *tuple = (PyObject *)&arg_tuple;\n";
+  }
+  out << "  (void)PyObject_INIT_VAR((PyVarObject *)tuple, &PyTuple_Type, nargs);\n";
+  out << "  for (Py_ssize_t i = 0; i < nargs; ++i) {\n";
+  out << "    PyTuple_SET_ITEM(tuple, i, args[i]);\n";
+  out << "  }\n";
+  out << "\n";
+  out << "  PyObject *self = Dtool_new_" << ClassName << "((PyTypeObject *)type, nullptr, nullptr);\n";
+  out << "  if (self != nullptr && Dtool_Init_" << ClassName << "(self, tuple, nullptr) != 0) {\n";
+  out << "    Py_DECREF(self);\n";
+  out << "    self = nullptr;\n";
+  out << "  }\n";
+  out << "#ifdef Py_TRACE_REFS\n";
+  out << "  _Py_ForgetReference(tuple);\n";
+  out << "#endif\n";
+  out << "  return self;\n";
+  out << "}\n";
+  out << "#endif  // PY_VERSION_HEX >= 0x03090000\n\n";
+}
+
+/**
+ * Returns the struct module format character describing the indicated
+ * element type, for use in a buffer exported via the buffer protocol, or the
+ * empty string if the type is not a simple numeric type.
+ */
+string InterfaceMakerPythonNative::
+get_buffer_format(CPPType *type) {
+  if (TypeManager::is_bool(type) || TypeManager::is_enum(type)) {
+    // Their size is implementation-defined.
+    return string();
+
+  } else if (TypeManager::is_double(type)) {
+    // Note that is_float() is also true for double, so this must come first.
+    // There is no format character for long double.
+    CPPSimpleType *simple_type = TypeManager::unwrap(type)->as_simple_type();
+    if (simple_type != nullptr &&
+        (simple_type->_flags & CPPSimpleType::F_long) == 0) {
+      return "d";
+    }
+
+  } else if (TypeManager::is_float(type)) {
+    return "f";
+
+  } else if (TypeManager::is_unsigned_char(type)) {
+    return "B";
+
+  } else if (TypeManager::is_signed_char(type)) {
+    return "b";
+
+  } else if (TypeManager::is_char(type)) {
+    return "c";
+
+  } else if (TypeManager::is_unsigned_short(type)) {
+    return "H";
+
+  } else if (TypeManager::is_short(type)) {
+    return "h";
+
+  } else if (TypeManager::is_unsigned_longlong(type)) {
+    return "Q";
+
+  } else if (TypeManager::is_longlong(type)) {
+    return "q";
+
+  } else if (TypeManager::is_long(type)) {
+    return TypeManager::is_unsigned_integer(type) ? "L" : "l";
+
+  } else if (TypeManager::is_integer(type) && !TypeManager::is_wchar(type)) {
+    CPPSimpleType *simple_type = TypeManager::unwrap(type)->as_simple_type();
+    if (simple_type != nullptr && simple_type->_type == CPPSimpleType::T_int) {
+      return TypeManager::is_unsigned_integer(type) ? "I" : "i";
+    }
+  }
+
+  return string();
+}
+
+/**
+ * Writes a bf_getbuffer implementation for a class that is backed by a vector
+ * of a simple numeric type, which exports a read-only copy of the vector's
+ * contents with a single memcpy rather than converting each element.
+ */
+void InterfaceMakerPythonNative::
+write_vector_getbuffer(ostream &out, Object *obj, const string &format) {
+  std::string ClassName = make_safe_name(obj->_itype.get_scoped_name());
+  std::string cClassName = obj->_itype.get_true_name();
+
+  out << "//////////////////\n";
+  out << "//  A bf_getbuffer implementation for the vector storage of\n";
+  out << "//     " << ClassName << "\n";
+  out << "//////////////////\n";
+  out << "static int Dtool_GetBuffer_" << ClassName << "(PyObject *self, Py_buffer *buffer, int flags) {\n";
+  out << "  " << cClassName << " *local_this = nullptr;\n";
+  out << "  if (!Dtool_Call_ExtractThisPointer(self, Dtool_" << ClassName << ", (void **)&local_this)) {\n";
+  out << "    return -1;\n";
+  out << "  }\n";
+  out << "  return Dtool_GetVectorBuffer(self, buffer, flags, (const void *)local_this->data(),\n";
+  out << "                               (Py_ssize_t)local_this->size(), (Py_ssize_t)sizeof(*local_this->data()),\n";
+  out << "                               \"" << format << "\");\n";
+  out << "}\n\n";
+}
+
 /**
  * Special case optimization: if the last map is a subset of the map before
  * it, we can merge the cases.  When this happens, we can make use of a
@@ -4950,6 +5391,200 @@ bool RemapCompareLess(FunctionRemap *in1, FunctionRemap *in2) {
   return false;
 }
 
+/**
+ * Returns the DtoolArgKind mask of the Python objects that the non-coercion
+ * conversion for the given parameter could possibly accept, or the empty
+ * string if we can't rule anything out.  This must be kept in sync with the
+ * conversions written by write_function_instance().
+ */
+string InterfaceMakerPythonNative::
+get_arg_kind_mask(ParameterRemap *param) {
+  CPPType *orig_type = param->get_orig_type();
+  CPPType *type = param->get_new_type();
+
+  if (param->new_type_is_atomic_string()) {
+    if (TypeManager::is_char_pointer(orig_type) ||
+        TypeManager::is_wchar_pointer(orig_type)) {
+      // These accept None.
+      return string();
+    }
+    return "DAK_string_like";
+
+  } else if (TypeManager::is_vector_unsigned_char(type) ||
+             TypeManager::is_scoped_enum(type) ||
+             TypeManager::is_bool(type)) {
+    return string();
+
+  } else if (TypeManager::is_nullptr(type)) {
+    return "DAK_none";
+
+  } else if (TypeManager::is_char(type) ||
+             TypeManager::is_wchar(type)) {
+    return string();
+
+  } else if (TypeManager::is_ssize(type) ||
+             TypeManager::is_size(type) ||
+             TypeManager::is_longlong(type) ||
+             TypeManager::is_unsigned_short(type) ||
+             TypeManager::is_unsigned_char(type) ||
+             TypeManager::is_signed_char(type) ||
+             TypeManager::is_short(type) ||
+             TypeManager::is_unsigned_integer(type) ||
+             TypeManager::is_long(type) ||
+             TypeManager::is_integer(type) ||
+             TypeManager::is_double(type) ||
+             TypeManager::is_float(type)) {
+    return "DAK_number_like";
+
+  } else if (TypeManager::is_const_char_pointer(type) ||
+             TypeManager::is_pointer_to_PyTypeObject(type) ||
+             TypeManager::is_pointer_to_PyStringObject(type) ||
+             TypeManager::is_pointer_to_PyUnicodeObject(type) ||
+             TypeManager::is_pointer_to_PyObject(type) ||
+             TypeManager::is_pointer_to_Py_buffer(type) ||
+             TypeManager::is_pointer_to_simple(type)) {
+    return string();
+
+  } else if (TypeManager::is_pointer(type)) {
+    // Without coercion, this has to be a wrapped object, or None if the
+    // parameter has a default value of nullptr.
+    if (param->get_default_value() != nullptr) {
+      return "DAK_instance_or_none";
+    }
+    return "DAK_instance";
+  }
+
+  return string();
+}
+
+/**
+ * Returns an expression that is false if the arguments, as classified by the
+ * code written by write_function_forset(), can't possibly be accepted by the
+ * given remap without coercion, or the empty string if there is no such test.
+ *
+ * num_kinds is raised to the number of positional arguments that the
+ * expression refers to.
+ */
+string InterfaceMakerPythonNative::
+get_overload_guard(FunctionRemap *remap, int max_num_args,
+                   ArgsType args_type, int &num_kinds) {
+  if (remap->_flags & FunctionRemap::F_explicit_args) {
+    return string();
+  }
+
+  // This mirrors the way write_function_instance() assigns the parameters
+  // to the positional arguments.
+  int num_params = max_num_args;
+  int pn = 0;
+  if (remap->_has_this) {
+    num_params += 1;
+    pn = 1;
+  }
+  num_params = std::min(num_params, (int)remap->_parameters.size());
+
+  string guard;
+  int index = 0;
+  for (; pn < num_params; ++pn) {
+    ParameterRemap *param = remap->_parameters[pn]._remap;
+    if (!is_cpp_type_legal(param->get_orig_type())) {
+      continue;
+    }
+
+    string mask = get_arg_kind_mask(param);
+    if (!mask.empty()) {
+      if (!guard.empty()) {
+        guard += " && ";
+      }
+      if (args_type == AT_single_arg) {
+        guard += "(arg_kind & " + mask + ")";
+      } else {
+        guard += "(arg_kinds[" + format_string(index) + "] & " + mask + ")";
+        num_kinds = std::max(num_kinds, index + 1);
+      }
+    }
+    ++index;
+  }
+
+  return guard;
+}
+
+/**
+ * Writes the opening of an if statement that extracts the keyword arguments
+ * for a function by matching them against interned keyword names, and then
+ * converts them with the typed Dtool_ConvertArg() overloads.  This replaces a
+ * call to PyArg_ParseTupleAndKeywords, which has to compare every keyword
+ * against every parameter name by string value and interpret a format string
+ * on every call.  The condition is left open so that the caller can append
+ * further checks and the closing parenthesis.
+ *
+ * Returns false, writing nothing, if any of the parameters uses a format
+ * specifier that has no typed converter.
+ */
+bool InterfaceMakerPythonNative::
+write_keyword_arg_extraction(ostream &out, int indent_level,
+                             const string &method_name,
+                             const string &format_specifiers,
+                             const string &parameter_list,
+                             const string &keyword_list) {
+  vector_string params;
+  tokenize(parameter_list, params, ", &", true);
+  params.erase(std::remove(params.begin(), params.end(), string()), params.end());
+
+  // Each of the format specifiers we accept here corresponds to exactly one
+  // parameter, so we can easily pair them up.
+  int min_num_args = -1;
+  int num_args = 0;
+  for (char spec : format_specifiers) {
+    switch (spec) {
+    case '|':
+      min_num_args = num_args;
+      break;
+
+    case 'O':
+    case 'f':
+    case 'd':
+    case 'i':
+    case 'l':
+    case 'L':
+    case 'K':
+      ++num_args;
+      break;
+
+    default:
+      return false;
+    }
+  }
+  if (num_args == 0 || num_args != (int)params.size()) {
+    return false;
+  }
+  if (min_num_args < 0) {
+    min_num_args = num_args;
+  }
+
+  indent(out, indent_level)
+    << "static const char *const keyword_list[] = {" << keyword_list << "};\n";
+  indent(out, indent_level)
+    << "static std::atomic<PyObject *> keyword_names[" << num_args << "];\n";
+  indent(out, indent_level)
+    << "PyObject *arg_values[" << num_args << "];\n";
+  indent(out, indent_level)
+    << "if (Dtool_ExtractArgs(arg_values, args, kwds, \"" << method_name
+    << "\", keyword_list, keyword_names, " << min_num_args << ", "
+    << num_args << ")";
+
+  for (int i = 0; i < num_args; ++i) {
+    out << " &&\n";
+    indent(out, indent_level + 4);
+    if (i < min_num_args) {
+      out << "Dtool_ConvertArg(arg_values[" << i << "], " << params[i] << ")";
+    } else {
+      out << "(arg_values[" << i << "] == nullptr || Dtool_ConvertArg(arg_values["
+          << i << "], " << params[i] << "))";
+    }
+  }
+  return true;
+}
+
 /**
  * Writes out a set of function wrappers that handle all instances of a
  * particular function with the same number of parameters.  (Actually, in some
@@ -5077,6 +5712,39 @@ write_function_forset(ostream &out,
     std::sort(remaps.begin(), remaps.end(), RemapCompareLess);
     std::vector<FunctionRemap *>::const_iterator sii;
 
+    // Determine which overloads we can rule out just by looking at what kind
+    // of object was passed for each argument.  This saves us from having to
+    // try to parse the arguments for each of them in turn.
+    std::map<FunctionRemap *, string> guards;
+    int num_kinds = 0;
+    if (first_pexpr.empty() && (args_type == AT_single_arg ||
+                                args_type == AT_varargs ||
+                                args_type == AT_keyword_args)) {
+      for (FunctionRemap *remap : remaps) {
+        guards[remap] = get_overload_guard(remap, max_num_args, args_type, num_kinds);
+      }
+    }
+
+    bool classify_args = false;
+    if (args_type == AT_single_arg) {
+      for (FunctionRemap *remap : remaps) {
+        if (!guards[remap].empty()) {
+          classify_args = true;
+        }
+      }
+      if (classify_args) {
+        indent(out, indent_level) << "{\n";
+        indent_level += 2;
+        indent(out, indent_level) << "int arg_kind = Dtool_ClassifyArg(arg);\n";
+      }
+    } else if (num_kinds > 0) {
+      classify_args = true;
+      indent(out, indent_level) << "{\n";
+      indent_level += 2;
+      indent(out, indent_level) << "int arg_kinds[" << num_kinds << "];\n";
+      indent(out, indent_level) << "Dtool_ClassifyArgs(args, arg_kinds, " << num_kinds << ");\n";
+    }
+
     int num_coercion_possible = 0;
     bool caught_all = false;
     sii = remaps.begin();
@@ -5102,10 +5770,18 @@ write_function_forset(ostream &out,
       }
 
       bool remap_verify_const = verify_const && (remap->_has_this && !remap->_const_method);
+      const string &guard = guards[remap];
       if (remap_verify_const) {
         // If it's a non-const method, we only allow a non-const this.
         indent(out, indent_level)
-          << "if (!DtoolInstance_IS_CONST(self)) {\n";
+          << "if (!DtoolInstance_IS_CONST(self)";
+        if (!guard.empty()) {
+          out << " && " << guard;
+        }
+        out << ") {\n";
+      } else if (!guard.empty()) {
+        indent(out, indent_level)
+          << "if (" << guard << ") {\n";
       } else {
         indent(out, indent_level)
           << "{\n";
@@ -5123,7 +5799,7 @@ write_function_forset(ostream &out,
                                   false, false, args_type, return_flags,
                                   check_exceptions, first_pexpr)) {
         // The rest of the overloads are dead code.
-        if (!remap_verify_const) {
+        if (!remap_verify_const && guard.empty()) {
           caught_all = true;
           //indent(out, indent_level) << "  // caught all cases here\n";
         }
@@ -5132,6 +5808,11 @@ write_function_forset(ostream &out,
       indent(out, indent_level) << "}\n\n";
     }
 
+    if (classify_args) {
+      indent_level -= 2;
+      indent(out, indent_level) << "}\n\n";
+    }
+
     // Go through one more time, but allow coercion this time.
     if (coercion_allowed && !caught_all) {
       for (sii = remaps.begin(); sii != remaps.end(); ++sii) {
@@ -6536,6 +7217,14 @@ write_function_instance(ostream &out, FunctionRemap *remap,
               << "if (Dtool_ExtractOptionalArg(&" << param_name << ", args, kwds, " << keyword_list_new << ")"
               << extra_type_check_str << ") {\n";
           }
+        } else if (write_keyword_arg_extraction(out, indent_level, method_name,
+                                                format_specifiers, parameter_list,
+                                                keyword_list_new)) {
+          // The arguments are matched up against interned keyword names and
+          // converted directly, without going through a format string.
+          clear_error = true;
+          out << extra_type_check_str << ") {\n";
+
         } else {
           // We have to use the more expensive PyArg_ParseTupleAndKeywords.
           clear_error = true;
@@ -7510,7 +8199,23 @@ write_getset(ostream &out, Object *obj, Property *property) {
 
   const InterrogateElement &ielem = property->_ielement;
 
+  // A plain data member may be accessed directly by the shared getter and
+  // setter, in which case we only need to describe where it is.
+  string member_type = get_member_type_code(obj, property);
+  if (!member_type.empty()) {
+    FunctionRemap *remap = property->_getter_remaps.front();
+    out << "static Dtool_MemberDef Dtool_" << ClassName << "_" << ielem.get_name() << "_MemberDef = {\n"
+        << "  {(char *)\"" << methodNameFromCppName(ielem.get_name(), "", false) << "\", "
+        << member_type << ", (Py_ssize_t)offsetof(" << cClassName << ", " << remap->_expression << "), "
+        << (property->_setter_remaps.empty() ? "READONLY" : "0") << ", nullptr},\n"
+        << "  &Dtool_" << ClassName << ",\n"
+        << "  \"" << classNameFromCppName(cClassName, false) << "." << ielem.get_name() << "\",\n"
+        << "};\n\n";
+    return;
+  }
+
   FunctionRemap *len_remap = nullptr;
+  FunctionRemap *fill_remap = nullptr;
   if (property->_length_function != nullptr) {
     assert(!property->_length_function->_remaps.empty());
 
@@ -7591,6 +8296,70 @@ write_getset(ostream &out, Object *obj, Property *property) {
     }
     out << "}\n\n";
 
+    // If there is only one getter, and it returns a simple value, we can also
+    // write a function that fetches a range of items in a tight loop, saving
+    // a call per item when iterating over or searching through the sequence.
+    if (remaps.size() == 1) {
+      FunctionRemap *remap = *remaps.begin();
+      CPPType *return_type = remap->_return_type->get_new_type();
+      if (remap->_has_this == property->_has_this && !remap->_blocking &&
+          (remap->_flags & (FunctionRemap::F_explicit_self | FunctionRemap::F_explicit_args)) == 0 &&
+          !TypeManager::is_scoped_enum(return_type) &&
+          (remap->_return_type->new_type_is_atomic_string() ||
+           TypeManager::is_simple(return_type) ||
+           TypeManager::is_char_pointer(return_type) ||
+           TypeManager::is_wchar_pointer(return_type))) {
+        fill_remap = remap;
+      }
+    }
+
+    if (fill_remap != nullptr) {
+      out <<
+        "/**\n"
+        " * sequence bulk getter for property " << ielem.get_scoped_name() << "\n"
+        " */\n"
+        "static Py_ssize_t Dtool_" + ClassName + "_" + ielem.get_name() + "_Sequence_Fill(PyObject *self, PyObject **items, Py_ssize_t start, Py_ssize_t count) {\n";
+
+      if (property->_has_this) {
+        out <<
+          "  " << cClassName << " *local_this = nullptr;\n"
+          "  if (!Dtool_Call_ExtractThisPointer(self, Dtool_" << ClassName << ", (void **)&local_this)) {\n"
+          "    return -1;\n"
+          "  }\n";
+      }
+
+      out << "  Py_ssize_t end = (Py_ssize_t)"
+          << len_remap->get_call_str("local_this", pexprs) << ";\n";
+      out << "  if (start < 0 || start >= end) {\n";
+      out << "    return 0;\n";
+      out << "  }\n";
+      out << "  if (count < end - start) {\n";
+      out << "    end = start + count;\n";
+      out << "  }\n";
+      out << "  for (Py_ssize_t index = start; index < end; ++index) {\n";
+
+      vector_string fill_pexprs(fill_remap->_first_true_parameter + 1);
+      fill_pexprs.back() = "index";
+      string return_expr = fill_remap->call_function(out, 4, true, "local_this", fill_pexprs);
+      CPPType *type = fill_remap->_return_type->get_temporary_type();
+      indent(out, 4);
+      type->output_instance(out, "return_value", &parser);
+      out << " = " << return_expr << ";\n";
+
+      out << "    PyObject *item = Dtool_WrapValue(return_value);\n";
+      out << "    if (item == nullptr) {\n";
+      out << "      while (index > start) {\n";
+      out << "        --index;\n";
+      out << "        Py_DECREF(items[index - start]);\n";
+      out << "      }\n";
+      out << "      return -1;\n";
+      out << "    }\n";
+      out << "    items[index - start] = item;\n";
+      out << "  }\n";
+      out << "  return end - start;\n";
+      out << "}\n\n";
+    }
+
     // Write out a setitem if this is not a read-only property.
     if (!property->_setter_remaps.empty()) {
       out << "static int Dtool_" + ClassName + "_" + ielem.get_name() + "_Sequence_Setitem(PyObject *self, Py_ssize_t index, PyObject *arg) {\n";
@@ -7941,12 +8710,18 @@ write_getset(ostream &out, Object *obj, Property *property) {
         "  if (wrap != nullptr) {\n"
         "    wrap->_len_func = &Dtool_" << ClassName << "_" << ielem.get_name() << "_Len;\n"
         "    wrap->_getitem_func = &Dtool_" << ClassName << "_" << ielem.get_name() << "_Sequence_Getitem;\n";
+      if (fill_remap != nullptr) {
+        out << "    wrap->_fill_func = &Dtool_" << ClassName << "_" << ielem.get_name() << "_Sequence_Fill;\n";
+      }
     } else {
       out <<
         "  Dtool_MutableSequenceWrapper *wrap = Dtool_NewMutableSequenceWrapper(self, \"" << ClassName << "." << ielem.get_name() << "\");\n"
         "  if (wrap != nullptr) {\n"
         "    wrap->_len_func = &Dtool_" << ClassName << "_" << ielem.get_name() << "_Len;\n"
         "    wrap->_getitem_func = &Dtool_" << ClassName << "_" << ielem.get_name() << "_Sequence_Getitem;\n";
+      if (fill_remap != nullptr) {
+        out << "    wrap->_fill_func = &Dtool_" << ClassName << "_" << ielem.get_name() << "_Sequence_Fill;\n";
+      }
       if (!property->_setter_remaps.empty()) {
         if (property->_has_this) {
           out << "    if (!DtoolInstance_IS_CONST(self)) {\n";
@@ -8655,6 +9430,135 @@ IsRunTimeTyped(const InterrogateType &itype) {
   return false;
 }
 
+/**
+ * Returns true if we should write a tp_vectorcall implementation for this
+ * class, see write_vectorcall_constructor().
+ */
+bool InterfaceMakerPythonNative::
+has_vectorcall_constructor(Object *obj) {
+  if (!generate_vectorcall || obj->_constructors.empty()) {
+    return false;
+  }
+
+  // A custom __new__ may not return a fresh instance of this class.
+  for (Function *func : obj->_methods) {
+    if (func != nullptr && func->_ifunc.get_name() == "__new__") {
+      return false;
+    }
+  }
+
+  // A constructor taking the argument tuple directly may hold onto it, which
+  // is not possible if it lives on the stack.
+  for (Function *func : obj->_constructors) {
+    for (FunctionRemap *remap : func->_remaps) {
+      if (remap->_flags & FunctionRemap::F_explicit_args) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * If the property is a plain data member that can be accessed directly at
+ * its offset from the C++ pointer, by way of a Dtool_MemberDef, returns the
+ * T_* code from structmember.h describing its type.  Otherwise, returns the
+ * empty string.  This is only done when -memberdefs is given.
+ */
+string InterfaceMakerPythonNative::
+get_member_type_code(Object *obj, Property *property) {
+  if (!generate_memberdefs || !property->_has_this ||
+      property->_getter_remaps.size() != 1 ||
+      property->_length_function != nullptr ||
+      property->_has_function != nullptr ||
+      property->_clear_function != nullptr ||
+      property->_deleter != nullptr) {
+    return string();
+  }
+
+  // The getter and setter must be the ones synthesized for a data member,
+  // not the methods named by a MAKE_PROPERTY.
+  FunctionRemap *remap = property->_getter_remaps.front();
+  if (remap->_type != FunctionRemap::T_getter || remap->_extension) {
+    return string();
+  }
+  for (FunctionRemap *setter : property->_setter_remaps) {
+    if (setter->_type != FunctionRemap::T_setter || setter->_extension) {
+      return string();
+    }
+  }
+
+  // The offset is computed with offsetof, which is only well-defined for a
+  // standard-layout class, and can't take a type name containing a comma.
+  CPPStructType *struct_type = obj->_itype._cpptype->as_struct_type();
+  if (struct_type == nullptr || !struct_type->is_standard_layout() ||
+      obj->_itype.get_true_name().find(',') != string::npos) {
+    return string();
+  }
+
+  // A static method with the same name needs the special handling in the
+  // generated getter, see write_getset().
+  for (const Function *func : obj->_methods) {
+    if (!func->_has_this && func->_ifunc.get_name() == property->_ielement.get_name()) {
+      return string();
+    }
+  }
+
+  // Look up the member itself, since we can't take the offset of a bitfield.
+  CPPScope *scope = struct_type->get_scope();
+  CPPDeclaration *decl = scope->find_symbol(remap->_expression, false);
+  CPPInstance *member = (decl != nullptr) ? decl->as_instance() : nullptr;
+  if (member == nullptr || member->_bit_width != -1 ||
+      (member->_storage_class & CPPInstance::SC_static) != 0) {
+    return string();
+  }
+
+  CPPType *type = TypeManager::resolve_type(member->_type, scope);
+  if (TypeManager::is_enum(type) || TypeManager::is_char(type) ||
+      TypeManager::is_unsigned_char(type) || TypeManager::is_signed_char(type) ||
+      TypeManager::is_wchar(type)) {
+    return string();
+
+  } else if (TypeManager::is_bool(type)) {
+    return "T_BOOL";
+
+  } else if (TypeManager::is_double(type)) {
+    // Note that is_float() is also true for double, so this must come first.
+    // long double has no T_* code, so it is accessed via the getter.
+    CPPSimpleType *simple_type = TypeManager::unwrap(type)->as_simple_type();
+    if (simple_type != nullptr &&
+        (simple_type->_flags & CPPSimpleType::F_long) == 0) {
+      return "T_DOUBLE";
+    }
+
+  } else if (TypeManager::is_float(type)) {
+    return "T_FLOAT";
+
+  } else if (TypeManager::is_unsigned_short(type)) {
+    return "T_USHORT";
+
+  } else if (TypeManager::is_short(type)) {
+    return "T_SHORT";
+
+  } else if (TypeManager::is_unsigned_longlong(type)) {
+    return "T_ULONGLONG";
+
+  } else if (TypeManager::is_longlong(type)) {
+    return "T_LONGLONG";
+
+  } else if (TypeManager::is_long(type)) {
+    return TypeManager::is_unsigned_integer(type) ? "T_ULONG" : "T_LONG";
+
+  } else if (TypeManager::is_integer(type)) {
+    CPPSimpleType *simple_type = TypeManager::unwrap(type)->as_simple_type();
+    if (simple_type != nullptr && simple_type->_type == CPPSimpleType::T_int) {
+      return TypeManager::is_unsigned_integer(type) ? "T_UINT" : "T_INT";
+    }
+  }
+
+  return string();
+}
+
 /**
  * Returns true if this object has special support for inheriting from Python.
  */
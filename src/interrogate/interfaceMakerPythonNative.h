@@ -36,6 +36,8 @@ public:
   void write_prototypes_class_external(std::ostream &out, Object *obj);
 
   virtual void write_functions(std::ostream &out);
+  void write_sharded_functions(std::ostream &out,
+                               const std::vector<std::ostream *> &shards);
 
   virtual void write_module(std::ostream &out, std::ostream *out_h, InterrogateModuleDef *def);
   virtual void write_module_support(std::ostream &out, std::ostream *out_h, InterrogateModuleDef *def);
@@ -155,10 +157,23 @@ private:
                                ArgsType args_type, int return_flags,
                                bool exclusive_fastcall = false);
   void write_coerce_constructor(std::ostream &out, Object *obj, bool is_const);
+  void write_vectorcall_constructor(std::ostream &out, Object *obj);
+  void write_vector_getbuffer(std::ostream &out, Object *obj,
+                              const std::string &format);
 
   int collapse_default_remaps(std::map<int, std::set<FunctionRemap *> > &map_sets,
                               int max_required_args);
 
+  std::string get_arg_kind_mask(ParameterRemap *param);
+  static std::string get_buffer_format(CPPType *type);
+  std::string get_overload_guard(FunctionRemap *remap, int max_num_args,
+                                 ArgsType args_type, int &num_kinds);
+  bool write_keyword_arg_extraction(std::ostream &out, int indent_level,
+                                    const std::string &method_name,
+                                    const std::string &format_specifiers,
+                                    const std::string &parameter_list,
+                                    const std::string &keyword_list);
+
   bool write_function_forset(std::ostream &out,
                              const std::set<FunctionRemap*> &remaps,
                              int min_num_args, int max_num_args,
@@ -192,11 +207,17 @@ private:
 
   void write_class_prototypes(std::ostream &out) ;
   void write_class_declarations(std::ostream &out, std::ostream *out_h, Object *obj);
+  void write_class_definition(std::ostream &out, Object *obj);
   void write_class_details(std::ostream &out, Object *obj);
+  void write_exports(std::ostream &out);
+  void get_sorted_imports(std::vector<CPPType *> &result) const;
+  std::string get_imports_name() const;
 
 public:
   bool is_remap_legal(FunctionRemap *remap);
   int has_coerce_constructor(CPPStructType *type);
+  bool has_vectorcall_constructor(Object *obj);
+  std::string get_member_type_code(Object *obj, Property *property);
   bool is_remap_coercion_possible(FunctionRemap *remap);
   bool is_function_legal(Function *func);
   bool is_cpp_type_legal(CPPType *ctype);
@@ -232,6 +253,11 @@ public:
 
   // stash the forward declarations for this compile pass..
   std::set<CPPType *> _external_imports;
+
+private:
+  // Set by write_sharded_functions() when the class wrappers are being
+  // spread across several translation units.
+  bool _split_output = false;
 };
 
 #endif
@@ -19,6 +19,7 @@
 #include "pnotify.h"
 #include "panda_getopt_long.h"
 #include "preprocess_argv.h"
+#include "string_utils.h"
 #include <time.h>
 
 using std::cerr;
@@ -34,6 +35,8 @@ Filename output_include_filename;
 Filename output_data_filename;
 Filename output_text_filename;
 Filename source_file_directory;
+Filename snapshot_out_filename;
+Filename snapshot_in_filename;
 string output_data_basename;
 bool output_module_specific = false;
 bool output_function_pointers = false;
@@ -50,8 +53,13 @@ bool track_interpreter = false;
 bool save_unique_names = false;
 bool no_database = false;
 bool generate_spam = false;
+bool generate_vectorcall = false;
+bool generate_memberdefs = false;
+bool use_runtime_library = false;
+bool binary_database = false;
 bool left_inheritance_requires_upcast = true;
 bool mangle_names = true;
+int num_split_files = 1;
 CPPVisibility min_vis = V_published;
 string library_name;
 string module_name;
@@ -86,6 +94,13 @@ enum CommandOptions {
   CO_spam,
   CO_noangles,
   CO_nomangle,
+  CO_pch_out,
+  CO_pch_in,
+  CO_split,
+  CO_vectorcall,
+  CO_memberdefs,
+  CO_runtime_library,
+  CO_binary_db,
   CO_help,
 };
 
@@ -115,6 +130,13 @@ static struct option long_options[] = {
   { "spam", no_argument, nullptr, CO_spam },
   { "noangles", no_argument, nullptr, CO_noangles },
   { "nomangle", no_argument, nullptr, CO_nomangle },
+  { "pch-out", required_argument, nullptr, CO_pch_out },
+  { "pch-in", required_argument, nullptr, CO_pch_in },
+  { "split", required_argument, nullptr, CO_split },
+  { "vectorcall", no_argument, nullptr, CO_vectorcall },
+  { "memberdefs", no_argument, nullptr, CO_memberdefs },
+  { "runtime-library", no_argument, nullptr, CO_runtime_library },
+  { "binary-db", no_argument, nullptr, CO_binary_db },
   { "help", no_argument, nullptr, CO_help },
   { nullptr }
 };
@@ -159,6 +181,11 @@ void show_help() {
     << "        when the scripting language first calls some interrogate query\n"
     << "        function.\n\n"
 
+    << "  -binary-db\n"
+    << "        Write the file named by -od in a binary format that is memory-mapped\n"
+    << "        when it is read back, which loads much faster than the default text\n"
+    << "        format.  Both formats are recognized automatically when reading.\n\n"
+
     << "  -srcdir directory\n"
     << "        Specify the name of the directory to which the source filenames are\n"
     << "        relative.\n\n"
@@ -292,7 +319,51 @@ void show_help() {
     << "        and -S are equivalent.\n\n"
 
     << "  -nomangle\n"
-    << "        Do not generate camelCase equivalents of functions.\n\n";
+    << "        Do not generate camelCase equivalents of functions.\n\n"
+
+    << "  -pch-out snapshot.pch\n"
+    << "        After parsing the files named on the command line, save the\n"
+    << "        preprocessed tokens, comments, macro definitions and include\n"
+    << "        guards to the indicated file, so that a later run can load them\n"
+    << "        with -pch-in.  This is intended to be used with a single header\n"
+    << "        that includes the headers common to a number of libraries.\n\n"
+
+    << "  -pch-in snapshot.pch\n"
+    << "        Before parsing the files named on the command line, load a\n"
+    << "        snapshot written by -pch-out, as though the files parsed in that\n"
+    << "        run were included first.  The files are not read or preprocessed\n"
+    << "        again, and are subsequently skipped if they are included with an\n"
+    << "        include guard or #pragma once.  The snapshot should only be used\n"
+    << "        with the same build of interrogate and the same -D, -I and -S\n"
+    << "        options that were used to write it.\n\n"
+
+    << "  -split N\n"
+    << "        Distribute the generated class wrappers across N source files, so\n"
+    << "        that they may be compiled in parallel.  The first file is the one\n"
+    << "        named by -oc, which also contains the global functions and the\n"
+    << "        module tables; the others are named by appending _1, _2, etc. to\n"
+    << "        its basename.  The declarations shared between these files are\n"
+    << "        written to a header named by appending _shared.h to the basename.\n"
+    << "        This is only supported with -python-native.\n\n"
+
+    << "  -vectorcall\n"
+    << "        Give each generated class a tp_vectorcall implementation, which\n"
+    << "        speeds up constructing instances from Python 3.9 onward by\n"
+    << "        calling the constructor wrapper without going through\n"
+    << "        type.__call__.  Only meaningful with -python-native.\n\n"
+
+    << "  -memberdefs\n"
+    << "        Expose published data members of numeric or bool type, in classes\n"
+    << "        with a standard layout, through a shared getter and setter that\n"
+    << "        access the member directly at its offset, like a PyMemberDef,\n"
+    << "        instead of generating a wrapper function for each.  Only\n"
+    << "        meaningful with -python-native.\n\n"
+
+    << "  -runtime-library\n"
+    << "        Declare the Python support code as being imported from the shared\n"
+    << "        interrogate_runtime library, which the module must then be linked\n"
+    << "        against.  Pass the same option to interrogate_module.  Only\n"
+    << "        meaningful with -python-native.\n\n";
 }
 
 // handle commandline -D options
@@ -464,6 +535,40 @@ main(int argc, char **argv) {
       mangle_names = false;
       break;
 
+    case CO_pch_out:
+      snapshot_out_filename = Filename::from_os_specific(optarg);
+      snapshot_out_filename.make_absolute();
+      break;
+
+    case CO_pch_in:
+      snapshot_in_filename = Filename::from_os_specific(optarg);
+      snapshot_in_filename.make_absolute();
+      break;
+
+    case CO_split:
+      num_split_files = atoi(optarg);
+      if (num_split_files < 1) {
+        cerr << "Invalid number of files for -split: " << optarg << "\n";
+        exit(1);
+      }
+      break;
+
+    case CO_vectorcall:
+      generate_vectorcall = true;
+      break;
+
+    case CO_memberdefs:
+      generate_memberdefs = true;
+      break;
+
+    case CO_runtime_library:
+      use_runtime_library = true;
+      break;
+
+    case CO_binary_db:
+      binary_database = true;
+      break;
+
     case 'h':
     case CO_help:
       show_help();
@@ -496,7 +601,11 @@ main(int argc, char **argv) {
 // File Will be Set to %s \n",output_include_filename.c_str()); }
 
   output_code_filename.set_text();
-  output_data_filename.set_text();
+  if (binary_database) {
+    output_data_filename.set_binary();
+  } else {
+    output_data_filename.set_text();
+  }
   output_text_filename.set_text();
 // output_include_filename.set_text();
   output_data_basename = output_data_filename.get_basename();
@@ -514,6 +623,16 @@ main(int argc, char **argv) {
     build_c_wrappers = true;
   }
 
+  if (num_split_files > 1) {
+    if (!build_python_native || build_c_wrappers || build_python_wrappers ||
+        build_python_obj_wrappers || output_function_pointers) {
+      cerr
+        << "-split may only be used with -python-native, and cannot be\n"
+        << "combined with any other wrapper types or with -fptrs.\n";
+      exit(1);
+    }
+  }
+
   // Add all of the .h files we are explicitly including to the parser.
   for (i = 1; i < argc; ++i) {
     Filename filename = Filename::from_os_specific(argv[i]);
@@ -521,6 +640,18 @@ main(int argc, char **argv) {
     parser._explicit_files.insert(filename);
   }
 
+  // Pick up the state saved by a previous run, if requested.
+  if (!snapshot_in_filename.empty()) {
+    if (!parser.read_snapshot(snapshot_in_filename)) {
+      cerr << "interrogate failed to load snapshot: '"
+           << snapshot_in_filename << "'\n";
+      exit(1);
+    }
+  }
+  if (!snapshot_out_filename.empty()) {
+    parser.record_snapshot();
+  }
+
   // Now go through them again and feed them into the C++ parser.
   for (i = 1; i < argc; ++i) {
     Filename filename = Filename::from_os_specific(argv[i]);
@@ -531,6 +662,12 @@ main(int argc, char **argv) {
     builder.add_source_file(filename.to_os_generic());
   }
 
+  if (!snapshot_out_filename.empty()) {
+    if (!parser.write_snapshot(snapshot_out_filename)) {
+      exit(1);
+    }
+  }
+
   // Now that we've parsed all the source code, change the way things are
   // output from now on so we can compile our generated code using VC++.
   // Sheesh.
@@ -619,15 +756,29 @@ main(int argc, char **argv) {
     }
 
     if (build_python_native) {
+      if (use_runtime_library) {
+        output_buffer << "#define USE_INTERROGATE_RUNTIME 1\n";
+      }
       output_buffer << interrogate_preamble_python_native_h << "\n";
     }
 
     std::string output_buffer_str = output_buffer.str();
 
+    // If we are splitting the output, the preamble and the declarations go
+    // into a header that is included by each of the output files.
+    Filename shared_filename = output_code_filename;
+    std::ofstream output_shared;
+    if (num_split_files > 1) {
+      shared_filename = output_code_filename.get_fullpath_wo_extension() + "_shared.h";
+      shared_filename.set_text();
+      shared_filename.open_write(output_shared);
+    }
+
     std::ofstream output_code;
     output_code_filename.open_write(output_code);
 
-    output_code << output_buffer_str;
+    std::ostream &output_decl = (num_split_files > 1) ? (std::ostream &)output_shared : output_code;
+    output_decl << output_buffer_str;
 
     if (build_python_native) {
       int lineno = 2;
@@ -636,14 +787,53 @@ main(int argc, char **argv) {
           ++lineno;
         }
       }
-      output_code << "#line " << lineno << " \"" << output_code_filename << "\"\n";
+      output_decl << "#line " << lineno << " \"" << shared_filename << "\"\n";
+    }
+
+    // The remaining files just include the shared header.
+    std::vector<std::ofstream *> output_shards;
+    std::vector<std::ostream *> shards;
+    for (i = 0; i < num_split_files; ++i) {
+      Filename shard_filename = output_code_filename;
+      std::ofstream *shard = &output_code;
+      if (i > 0) {
+        shard_filename = output_code_filename.get_fullpath_wo_extension() +
+          "_" + format_string(i);
+        shard_filename.set_extension(output_code_filename.get_extension());
+        shard_filename.set_text();
+        shard = new std::ofstream;
+        shard_filename.open_write(*shard);
+        output_shards.push_back(shard);
+        shards.push_back(shard);
+      }
+      if (num_split_files > 1) {
+        *shard
+          << "/*\n"
+          << " * This file was generated by:\n"
+          << " * " << command_line << "\n"
+          << " *\n"
+          << " */\n\n"
+          << "#include \"" << shared_filename.get_basename() << "\"\n\n";
+      }
+      if (shard->fail()) {
+        nout << "Unable to write to " << shard_filename << "\n";
+        status = -1;
+      }
     }
 
-    if (output_code.fail()) {
-      nout << "Unable to write to " << output_code_filename << "\n";
+    if (output_decl.fail()) {
+      nout << "Unable to write to " << shared_filename << "\n";
       status = -1;
-    } else {
-      builder.write_code(output_code, the_output_include, def);
+    } else if (status == 0) {
+      if (num_split_files > 1) {
+        builder.write_code(output_code, the_output_include, def, &output_shared, &shards);
+      } else {
+        builder.write_code(output_code, the_output_include, def);
+      }
+    }
+
+    for (std::ofstream *shard : output_shards) {
+      delete shard;
     }
   }
 
@@ -660,7 +850,11 @@ main(int argc, char **argv) {
       nout << "Unable to write to " << output_data_filename << "\n";
       status = -1;
     } else {
-      InterrogateDatabase::get_ptr()->write(output_data, def);
+      if (binary_database) {
+        InterrogateDatabase::get_ptr()->write_binary(output_data, def);
+      } else {
+        InterrogateDatabase::get_ptr()->write(output_data, def);
+      }
     }
   }
 
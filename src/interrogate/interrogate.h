@@ -41,6 +41,9 @@ extern bool track_interpreter;
 extern bool save_unique_names;
 extern bool no_database;
 extern bool generate_spam;
+extern bool generate_vectorcall;
+extern bool generate_memberdefs;
+extern bool use_runtime_library;
 extern bool left_inheritance_requires_upcast;
 extern bool mangle_names;
 extern CPPVisibility min_vis;
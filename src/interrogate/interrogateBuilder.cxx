@@ -328,11 +328,18 @@ build() {
 
 /**
  * Generates all the code necessary to the indicated output stream.
+ *
+ * If out_shared and out_shards are given, the class wrappers are instead
+ * distributed across out_code and the streams in out_shards, and the
+ * declarations they have in common are written to out_shared, which each of
+ * them is expected to include.  This is only supported for python-native.
  */
 void InterrogateBuilder::
-write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def) {
+write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def,
+           ostream *out_shared, const std::vector<ostream *> *out_shards) {
   typedef std::vector<InterfaceMaker *> InterfaceMakers;
   InterfaceMakers makers;
+  InterfaceMakerPythonNative *native_maker = nullptr;
 
   if (build_c_wrappers) {
     InterfaceMaker *maker = new InterfaceMakerC(def);
@@ -352,6 +359,7 @@ write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def) {
   if (build_python_native) {
     InterfaceMakerPythonNative *maker = new InterfaceMakerPythonNative(def);
     makers.push_back(maker);
+    native_maker = maker;
   }
 
   EXPORT_IMPORT_PREFIX = std::string("EXPCL_") + def->module_name;
@@ -370,12 +378,18 @@ write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def) {
   // be using ahead of time (and can therefore generate correct prototypes).
   ostringstream function_bodies;
   for (mi = makers.begin(); mi != makers.end(); ++mi) {
-    (*mi)->write_functions(function_bodies);
+    if (out_shards != nullptr && (*mi) == native_maker) {
+      native_maker->write_sharded_functions(function_bodies, *out_shards);
+    } else {
+      (*mi)->write_functions(function_bodies);
+    }
   }
 
+  ostream &out_decl = (out_shared != nullptr) ? *out_shared : out_code;
+
   // Now, begin the actual output.  Start with the #include lines.
   if (!no_database) {
-    out_code << "#include \"dtoolbase.h\"\n"
+    out_decl << "#include \"dtoolbase.h\"\n"
              << "#include \"interrogate_request.h\"\n"
              << "#include \"dconfig.h\"\n";
   }
@@ -425,7 +439,7 @@ write_code(ostream &out_code,ostream * out_include, InterrogateModuleDef *def) {
   declaration_bodies << "\n";
 
 // if(out_include != NULL) (*out_include) << declaration_bodies.str(); else
-  out_code << declaration_bodies.str();
+  out_decl << declaration_bodies.str();
 
   // Followed by the function bodies.
   out_code << function_bodies.str() << "\n";
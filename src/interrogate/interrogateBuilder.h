@@ -56,7 +56,9 @@ public:
   void read_command_file(std::istream &in);
   void do_command(const std::string &command, const std::string &params);
   void build();
-  void write_code(std::ostream &out_code, std::ostream *out_include, InterrogateModuleDef *def);
+  void write_code(std::ostream &out_code, std::ostream *out_include, InterrogateModuleDef *def,
+                  std::ostream *out_shared = nullptr,
+                  const std::vector<std::ostream *> *out_shards = nullptr);
   InterrogateModuleDef *make_module_def(int file_identifier);
 
   static std::string clean_identifier(const std::string &name);
@@ -32,8 +32,9 @@
 using std::cerr;
 using std::string;
 
-// This contains a big source string determined at compile time.
+// These contain big source strings determined at compile time.
 extern const char interrogate_preamble_python_native[];
+extern const char interrogate_preamble_python_native_h[];
 
 Filename output_code_filename;
 string module_name;
@@ -42,6 +43,7 @@ bool build_c_wrappers = false;
 bool build_python_wrappers = false;
 bool build_python_native_wrappers = false;
 bool track_interpreter = false;
+bool use_runtime_library = false;
 vector_string imports;
 vector_string init_funcs;
 
@@ -59,6 +61,7 @@ enum CommandOptions {
   CO_track_interpreter,
   CO_import,
   CO_init,
+  CO_runtime_library,
 };
 
 static struct option long_options[] = {
@@ -71,6 +74,7 @@ static struct option long_options[] = {
   { "track-interpreter", no_argument, nullptr, CO_track_interpreter },
   { "import", required_argument, nullptr, CO_import },
   { "init", required_argument, nullptr, CO_init },
+  { "runtime-library", no_argument, nullptr, CO_runtime_library },
   { nullptr }
 };
 
@@ -571,6 +575,10 @@ int main(int argc, char *argv[]) {
       init_funcs.push_back(optarg);
       break;
 
+    case CO_runtime_library:
+      use_runtime_library = true;
+      break;
+
     default:
       exit(1);
     }
@@ -621,9 +629,15 @@ int main(int argc, char *argv[]) {
     {
       std::ostringstream output_buffer;
 
-      // Output the support code.
+      // Output the support code, or only its declarations if it is provided
+      // by the interrogate_runtime library.
       if (build_python_native_wrappers) {
-        output_buffer << interrogate_preamble_python_native << "\n";
+        if (use_runtime_library) {
+          output_buffer << "#define USE_INTERROGATE_RUNTIME 1\n"
+                        << interrogate_preamble_python_native_h << "\n";
+        } else {
+          output_buffer << interrogate_preamble_python_native << "\n";
+        }
       }
       output_buffer_str = output_buffer.str();
     }
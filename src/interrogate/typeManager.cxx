@@ -14,6 +14,7 @@
 #include "typeManager.h"
 #include "interrogate.h"
 
+#include "cppArena.h"
 #include "cppArrayType.h"
 #include "cppConstType.h"
 #include "cppEnumType.h"
@@ -32,6 +33,8 @@
 
 using std::string;
 
+TypeManager::TraitCache *TypeManager::_traits = nullptr;
+
 /**
  * A horrible hack around a CPPParser bug.  We don't trust the CPPType pointer
  * we were given; instead, we ask CPPParser to parse a new type of the same
@@ -39,20 +42,19 @@ using std::string;
  */
 CPPType *TypeManager::
 resolve_type(CPPType *type, CPPScope *scope) {
-  if (scope == nullptr) {
-    scope = &parser;
+  if (scope != nullptr && scope != &parser) {
+    return type->resolve_type(scope, &parser);
   }
 
-  //CPPType *orig_type = type;
-  type = type->resolve_type(scope, &parser);
-  string name = type->get_local_name(&parser);
-  if (name.empty()) {
-    // Don't try to resolve unnamed types.
-    return type;
+  // Resolving a type in the global scope always gives the same answer once
+  // parsing is done, so we remember it.
+  Traits &traits = get_traits(type);
+  if (traits._resolved == nullptr) {
+    traits._resolved = type->resolve_type(&parser, &parser);
   }
 
   // I think I fixed the bug; no need for the below hack any more.
-  return type;
+  return traits._resolved;
 
 /*
   CPPType *new_type = parser.parse_type(name);
@@ -758,6 +760,14 @@ is_const_unsigned_char_pointer(CPPType *type) {
  */
 bool TypeManager::
 is_basic_string_char(CPPType *type) {
+  return get_trait(type, T_basic_string_char, &compute_is_basic_string_char);
+}
+
+/**
+ * Does the work for is_basic_string_char(), which caches the result.
+ */
+bool TypeManager::
+compute_is_basic_string_char(CPPType *type) {
   CPPType *string_type = get_basic_string_char_type();
   if (string_type != nullptr &&
       string_type->get_local_name(&parser) == type->get_local_name(&parser)) {
@@ -906,6 +916,14 @@ is_wchar_pointer(CPPType *type) {
  */
 bool TypeManager::
 is_basic_string_wchar(CPPType *type) {
+  return get_trait(type, T_basic_string_wchar, &compute_is_basic_string_wchar);
+}
+
+/**
+ * Does the work for is_basic_string_wchar(), which caches the result.
+ */
+bool TypeManager::
+compute_is_basic_string_wchar(CPPType *type) {
   CPPType *string_type = get_basic_string_wchar_type();
   if (string_type != nullptr &&
       string_type->get_local_name(&parser) == type->get_local_name(&parser)) {
@@ -1006,6 +1024,14 @@ is_wstring(CPPType *type) {
  */
 bool TypeManager::
 is_vector_unsigned_char(CPPType *type) {
+  return get_trait(type, T_vector_unsigned_char, &compute_is_vector_unsigned_char);
+}
+
+/**
+ * Does the work for is_vector_unsigned_char(), which caches the result.
+ */
+bool TypeManager::
+compute_is_vector_unsigned_char(CPPType *type) {
   if (type->get_local_name(&parser) == "vector< unsigned char >" ||
       type->get_local_name(&parser) == "std::vector< unsigned char >" ||
       type->get_local_name(&parser) == "pvector< unsigned char >") {
@@ -1061,6 +1087,57 @@ is_const_vector_unsigned_char(CPPType *type) {
   }
 }
 
+/**
+ * If the indicated type is a vector or pvector, or a class that publicly
+ * inherits from one, returns the element type of the vector.  Otherwise,
+ * returns NULL.  This is used to determine whether a class has contiguous
+ * storage that can be exposed via the buffer protocol.
+ */
+CPPType *TypeManager::
+get_vector_element_type(CPPType *type) {
+  switch (type->get_subtype()) {
+  case CPPDeclaration::ST_const:
+    return get_vector_element_type(type->as_const_type()->_wrapped_around);
+
+  case CPPDeclaration::ST_typedef:
+    return get_vector_element_type(type->as_typedef_type()->_type);
+
+  case CPPDeclaration::ST_struct:
+    {
+      CPPStructType *stype = type->as_struct_type();
+      string name = stype->get_simple_name();
+      if (name == "vector" || name == "pvector") {
+        CPPScope *scope = stype->get_scope();
+        if (scope != nullptr) {
+          CPPType *value_type = scope->find_type("value_type", false);
+          if (value_type != nullptr) {
+            return resolve_type(value_type);
+          }
+        }
+        return nullptr;
+      }
+
+      CPPStructType::Derivation::const_iterator di;
+      for (di = stype->_derivation.begin();
+           di != stype->_derivation.end();
+           ++di) {
+        if ((*di)._vis == V_public) {
+          CPPType *element_type = get_vector_element_type((*di)._base);
+          if (element_type != nullptr) {
+            return element_type;
+          }
+        }
+      }
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  return nullptr;
+}
+
 /**
  * Returns true if the indicated type is bool, or some trivial variant.
  */
@@ -1448,6 +1525,14 @@ is_void(CPPType *type) {
  */
 bool TypeManager::
 is_reference_count(CPPType *type) {
+  return get_trait(type, T_reference_count, &compute_is_reference_count);
+}
+
+/**
+ * Does the work for is_reference_count(), which caches the result.
+ */
+bool TypeManager::
+compute_is_reference_count(CPPType *type) {
   CPPType *refcount_type = get_reference_count_type();
   if (refcount_type != nullptr &&
       refcount_type->get_local_name(&parser) == type->get_local_name(&parser)) {
@@ -1517,6 +1602,14 @@ is_reference_count_pointer(CPPType *type) {
  */
 bool TypeManager::
 is_pointer_to_base(CPPType *type) {
+  return get_trait(type, T_pointer_to_base, &compute_is_pointer_to_base);
+}
+
+/**
+ * Does the work for is_pointer_to_base(), which caches the result.
+ */
+bool TypeManager::
+compute_is_pointer_to_base(CPPType *type) {
   // We only check the simple name of the type against PointerToBase, since we
   // need to allow for the various template instantiations of this thing.
 
@@ -1921,6 +2014,14 @@ is_pointer_to_ostream(CPPType *type) {
  */
 bool TypeManager::
 involves_unpublished(CPPType *type) {
+  return get_trait(type, T_unpublished, &compute_involves_unpublished);
+}
+
+/**
+ * Does the work for involves_unpublished(), which caches the result.
+ */
+bool TypeManager::
+compute_involves_unpublished(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return involves_unpublished(type->as_const_type()->_wrapped_around);
@@ -1999,6 +2100,14 @@ involves_unpublished(CPPType *type) {
  */
 bool TypeManager::
 involves_protected(CPPType *type) {
+  return get_trait(type, T_protected, &compute_involves_protected);
+}
+
+/**
+ * Does the work for involves_protected(), which caches the result.
+ */
+bool TypeManager::
+compute_involves_protected(CPPType *type) {
   switch (type->get_subtype()) {
   case CPPDeclaration::ST_const:
     return involves_protected(type->as_const_type()->_wrapped_around);
@@ -2464,6 +2573,14 @@ has_protected_destructor(CPPType *type) {
  */
 bool TypeManager::
 is_exported(CPPType *in_type) {
+  return get_trait(in_type, T_exported, &compute_is_exported);
+}
+
+/**
+ * Does the work for is_exported(), which caches the result.
+ */
+bool TypeManager::
+compute_is_exported(CPPType *in_type) {
   string name = in_type->get_local_name(&parser);
   if (name.empty()) {
     return false;
@@ -2632,3 +2749,48 @@ is_local(CPPType *source_type) {
  return false;
  */
 }
+
+/**
+ * Returns the cached traits of the indicated type, adding an empty entry for
+ * it if there is none yet.
+ */
+TypeManager::Traits &TypeManager::
+get_traits(const CPPType *type) {
+  if (_traits == nullptr) {
+    // The cache is never destroyed, since the global parser may release its
+    // arena during static destruction.  It is keyed on the type pointers,
+    // which may be reused for other types once that has happened.
+    _traits = new TraitCache;
+    CPPArena::add_release_callback(&release_traits);
+  }
+  return (*_traits)[type];
+}
+
+/**
+ * Called when a parser's arena is about to be released.  Forgets all of the
+ * cached traits, since they may refer to types allocated from it.
+ */
+void TypeManager::
+release_traits(CPPArena *) {
+  _traits->clear();
+}
+
+/**
+ * Returns the value of the indicated trait for the type, calling the given
+ * function to compute it the first time it is asked for.  This is only valid
+ * once parsing has finished, since the answer is not expected to change.
+ */
+bool TypeManager::
+get_trait(CPPType *type, int trait, bool (*compute)(CPPType *type)) {
+  // Note that references into an unordered_map remain valid even if
+  // computing the trait adds more types to the cache.
+  Traits &traits = get_traits(type);
+  if ((traits._known & trait) == 0) {
+    bool value = (*compute)(type);
+    traits._known |= trait;
+    if (value) {
+      traits._value |= trait;
+    }
+  }
+  return (traits._value & trait) != 0;
+}
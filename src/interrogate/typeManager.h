@@ -16,6 +16,9 @@
 
 #include "dtoolbase.h"
 
+#include <unordered_map>
+
+class CPPArena;
 class CPPFunctionGroup;
 class CPPInstance;
 class CPPType;
@@ -86,6 +89,7 @@ public:
   static bool is_wstring(CPPType *type);
   static bool is_vector_unsigned_char(CPPType *type);
   static bool is_const_vector_unsigned_char(CPPType *type);
+  static CPPType *get_vector_element_type(CPPType *type);
   static bool is_pair(CPPType *type);
   static bool is_bool(CPPType *type);
   static bool is_integer(CPPType *type);
@@ -153,6 +157,44 @@ public:
 
   static bool is_exported(CPPType *type);
   static bool is_local(CPPType *type);
+
+private:
+  // The results of the more expensive predicates are cached for each type,
+  // since the interface makers ask the same questions about the same types
+  // over and over.  Each trait is a bit in the Traits masks.
+  enum Trait {
+    T_basic_string_char    = 0x0001,
+    T_basic_string_wchar   = 0x0002,
+    T_vector_unsigned_char = 0x0004,
+    T_reference_count      = 0x0008,
+    T_pointer_to_base      = 0x0010,
+    T_unpublished          = 0x0020,
+    T_protected            = 0x0040,
+    T_exported             = 0x0080,
+  };
+
+  class Traits {
+  public:
+    int _known = 0;
+    int _value = 0;
+    CPPType *_resolved = nullptr;
+  };
+  typedef std::unordered_map<const CPPType *, Traits> TraitCache;
+  static TraitCache *_traits;
+
+  static Traits &get_traits(const CPPType *type);
+  static void release_traits(CPPArena *arena);
+  static bool get_trait(CPPType *type, int trait,
+                        bool (*compute)(CPPType *type));
+
+  static bool compute_is_basic_string_char(CPPType *type);
+  static bool compute_is_basic_string_wchar(CPPType *type);
+  static bool compute_is_vector_unsigned_char(CPPType *type);
+  static bool compute_is_reference_count(CPPType *type);
+  static bool compute_is_pointer_to_base(CPPType *type);
+  static bool compute_involves_unpublished(CPPType *type);
+  static bool compute_involves_protected(CPPType *type);
+  static bool compute_is_exported(CPPType *type);
 };
 
 #endif
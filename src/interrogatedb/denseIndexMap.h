@@ -0,0 +1,140 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file denseIndexMap.h
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#ifndef DENSEINDEXMAP_H
+#define DENSEINDEXMAP_H
+
+#include "dtoolbase.h"
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+/**
+ * A map from index numbers to values, used by the InterrogateDatabase to
+ * store its components.  It provides the subset of the STL map interface that
+ * the database needs, but takes advantage of the fact that index numbers are
+ * handed out consecutively, so that the components of one kind in one module
+ * occupy a contiguous range of index numbers.
+ *
+ * Each such range is stored as a block: an array of slots indexed by the
+ * index number minus the first index of the block.  A lookup is a binary
+ * search among the few blocks followed by an array access.  The values
+ * themselves are kept in a deque, so that references to them remain valid
+ * as more values are added, just as they would in an STL map.
+ */
+template<class Value>
+class DenseIndexMap {
+public:
+  typedef std::pair<const int, Value> value_type;
+
+  class reference {
+  public:
+    INLINE reference(int first, Value &second);
+
+    const int first;
+    Value &second;
+  };
+
+  class const_reference {
+  public:
+    INLINE const_reference(int first, const Value &second);
+
+    const int first;
+    const Value &second;
+  };
+
+  class iterator {
+  public:
+    INLINE iterator();
+    INLINE reference operator * () const;
+    INLINE iterator &operator ++ ();
+    INLINE bool operator == (const iterator &other) const;
+    INLINE bool operator != (const iterator &other) const;
+
+  private:
+    INLINE iterator(DenseIndexMap<Value> *map, size_t block, size_t slot);
+
+    DenseIndexMap<Value> *_map;
+    size_t _block;
+    size_t _slot;
+
+    friend class DenseIndexMap<Value>;
+  };
+
+  class const_iterator {
+  public:
+    INLINE const_iterator();
+    INLINE const_iterator(const iterator &copy);
+    INLINE const_reference operator * () const;
+    INLINE const_iterator &operator ++ ();
+    INLINE bool operator == (const const_iterator &other) const;
+    INLINE bool operator != (const const_iterator &other) const;
+
+  private:
+    INLINE const_iterator(const DenseIndexMap<Value> *map,
+                          size_t block, size_t slot);
+
+    const DenseIndexMap<Value> *_map;
+    size_t _block;
+    size_t _slot;
+
+    friend class DenseIndexMap<Value>;
+  };
+
+  INLINE DenseIndexMap();
+
+  INLINE size_t size() const;
+  INLINE bool empty() const;
+
+  INLINE iterator begin();
+  INLINE iterator end();
+  INLINE const_iterator begin() const;
+  INLINE const_iterator end() const;
+
+  iterator find(int index);
+  const_iterator find(int index) const;
+
+  std::pair<iterator, bool> insert(const value_type &value);
+  Value &operator [] (int index);
+
+  void erase(iterator it);
+  size_t erase(int index);
+
+  void clear();
+  void swap(DenseIndexMap<Value> &other);
+
+private:
+  size_t get_upper_block(int index) const;
+  bool find_slot(int index, size_t &block, size_t &slot) const;
+  int &make_slot(int index, size_t &block, size_t &slot);
+  int store_value(const Value &value);
+  void skip_empty(size_t &block, size_t &slot) const;
+
+  class Block {
+  public:
+    int _begin;
+    std::vector<int> _slots;
+  };
+  typedef std::vector<Block> Blocks;
+  Blocks _blocks;
+
+  typedef std::deque<Value> Values;
+  Values _values;
+  std::vector<int> _free_values;
+  size_t _size;
+};
+
+#include "denseIndexMap.I"
+
+#endif
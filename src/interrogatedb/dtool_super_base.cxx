@@ -11,7 +11,7 @@
  * @date 2005-07-04
  */
 
-#include "py_panda.h"
+#include "py_support.h"
 
 #ifdef HAVE_PYTHON
 
@@ -61,3 +61,33 @@ input(std::istream &in) {
     _alt_names.push_back(alt_name);
   }
 }
+
+/**
+ * Formats the component for output to a binary data file.
+ */
+void InterrogateComponent::
+output_binary(IDFBinaryWriter &out) const {
+  out.add_string(_name);
+  out.add_int((int)_alt_names.size());
+
+  Strings::const_iterator vi;
+  for (vi = _alt_names.begin(); vi != _alt_names.end(); ++vi) {
+    out.add_string(*vi);
+  }
+}
+
+/**
+ * Reads the binary data file as previously formatted by output_binary().
+ */
+void InterrogateComponent::
+input_binary(IDFBinaryReader &in) {
+  in.get_string(_name);
+
+  int num_alt_names = in.get_int();
+  _alt_names.clear();
+  for (int i = 0; i < num_alt_names && !in.is_error(); ++i) {
+    std::string alt_name;
+    in.get_string(alt_name);
+    _alt_names.push_back(alt_name);
+  }
+}
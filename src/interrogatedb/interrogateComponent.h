@@ -22,6 +22,8 @@
 #include <vector>
 
 class IndexRemapper;
+class IDFBinaryWriter;
+class IDFBinaryReader;
 
 /**
  * The base class for things that are part of the interrogate database.  This
@@ -48,6 +50,8 @@ public:
   void write_names(std::ostream &out) const;
   void output(std::ostream &out) const;
   void input(std::istream &in);
+  void output_binary(IDFBinaryWriter &out) const;
+  void input_binary(IDFBinaryReader &in);
 
 protected:
   static std::string _empty_string;
@@ -16,15 +16,32 @@
 #include "indexRemapper.h"
 #include "interrogate_datafile.h"
 
+#include <algorithm>
+#include <sstream>
+
+#ifdef HAVE_THREADS
+#include <system_error>
+#include <thread>
+#endif
+
 using std::map;
 using std::string;
 
 InterrogateDatabase *InterrogateDatabase::_global_ptr = nullptr;
-int InterrogateDatabase::_file_major_version = 0;
-int InterrogateDatabase::_file_minor_version = 0;
 int InterrogateDatabase::_current_major_version = 3;
 int InterrogateDatabase::_current_minor_version = 3;
 
+// The version of the database file being read.  The files may be read on
+// several threads at once, so each thread has its own.
+static thread_local int file_major_version = 0;
+static thread_local int file_minor_version = 0;
+
+#ifdef HAVE_THREADS
+// The most threads load_latest() will read database files on.  Beyond this,
+// more threads would just compete for the disk.
+static const size_t max_load_threads = 8;
+#endif
+
 /**
  *
  */
@@ -33,6 +50,20 @@ InterrogateDatabase() {
   _error_flag = false;
   _next_index = 1;
   _lookups_fresh = 0;
+  _lazy_loading = false;
+}
+
+/**
+ *
+ */
+InterrogateDatabase::
+~InterrogateDatabase() {
+  LazyModules::iterator mi;
+  for (mi = _lazy_modules.begin(); mi != _lazy_modules.end(); ++mi) {
+    delete (*mi)->_remap;
+    delete (*mi)->_file;
+    delete (*mi);
+  }
 }
 
 /**
@@ -92,6 +123,18 @@ request_module(InterrogateModuleDef *def) {
   }
 }
 
+/**
+ * Enables or disables lazy loading of the database files that are read from
+ * now on.  In lazy mode, only the index tables of a binary database file are
+ * read up front, and each type, function and function wrapper is decoded the
+ * first time it is accessed.  Database files in the text format are always
+ * read in full.
+ */
+void InterrogateDatabase::
+set_lazy_loading(bool lazy_loading) {
+  _lazy_loading = lazy_loading;
+}
+
 /**
  * Returns the global error flag.  This will be set true if there was some
  * problem importing the database (e.g.  cannot find an .in file), or false if
@@ -253,6 +296,9 @@ get_type(TypeIndex type) {
   TypeMap::const_iterator ti;
   ti = _type_map.find(type);
   if (ti == _type_map.end()) {
+    if (!_lazy_types.empty() && decode_lazy_type(type)) {
+      return _type_map[type];
+    }
     return bogus_type;
   }
   return (*ti).second;
@@ -270,6 +316,9 @@ get_function(FunctionIndex function) {
   FunctionMap::const_iterator fi;
   fi = _function_map.find(function);
   if (fi == _function_map.end()) {
+    if (!_lazy_functions.empty() && decode_lazy_function(function)) {
+      return *_function_map[function];
+    }
     return bogus_function;
   }
   return *(*fi).second;
@@ -287,6 +336,9 @@ get_wrapper(FunctionWrapperIndex wrapper) {
   FunctionWrapperMap::const_iterator wi;
   wi = _wrapper_map.find(wrapper);
   if (wi == _wrapper_map.end()) {
+    if (!_lazy_wrappers.empty() && decode_lazy_wrapper(wrapper)) {
+      return _wrapper_map[wrapper];
+    }
     return bogus_wrapper;
   }
   return (*wi).second;
@@ -349,6 +401,10 @@ get_make_seq(MakeSeqIndex make_seq) {
 void InterrogateDatabase::
 remove_type(TypeIndex type) {
   _type_map.erase(type);
+  _lazy_types.erase(type);
+  if (_lookups_fresh & LT_type_all) {
+    refresh_type_lookups(type);
+  }
 }
 
 /**
@@ -378,6 +434,9 @@ get_wrapper_by_unique_name(const string &unique_name) {
   // wrapper_hash_name.
 
   // The first four characters are always the library_name.
+  if (unique_name.size() < 4) {
+    return 0;
+  }
   string library_hash_name = unique_name.substr(0, 4);
   string wrapper_hash_name = unique_name.substr(4);
 
@@ -406,7 +465,7 @@ get_wrapper_by_unique_name(const string &unique_name) {
  */
 int InterrogateDatabase::
 get_file_major_version() {
-  return _file_major_version;
+  return file_major_version;
 }
 
 /**
@@ -415,7 +474,7 @@ get_file_major_version() {
  */
 int InterrogateDatabase::
 get_file_minor_version() {
-  return _file_minor_version;
+  return file_minor_version;
 }
 
 /**
@@ -477,6 +536,10 @@ add_type(TypeIndex index, const InterrogateType &type) {
     _global_types.push_back(index);
   }
   _all_types.push_back(index);
+
+  if (_lookups_fresh & LT_type_all) {
+    refresh_type_lookups(index);
+  }
 }
 
 /**
@@ -517,6 +580,10 @@ add_manifest(ManifestIndex index, const InterrogateManifest &manifest) {
   assert(inserted);
 
   _global_manifests.push_back(index);
+
+  if (_lookups_fresh & LT_manifest_name) {
+    refresh_manifest_lookups(index);
+  }
 }
 
 /**
@@ -531,6 +598,10 @@ add_element(ElementIndex index, const InterrogateElement &element) {
   if (element.is_global()) {
     _global_elements.push_back(index);
   }
+
+  if (_lookups_fresh & LT_element_all) {
+    refresh_element_lookups(index);
+  }
 }
 
 /**
@@ -551,6 +622,12 @@ InterrogateType &InterrogateDatabase::
 update_type(TypeIndex type) {
   assert(type != 0);
   check_latest();
+  if (!_lazy_types.empty()) {
+    decode_lazy_type(type);
+  }
+  if (_lookups_fresh & LT_type_all) {
+    _updated_types.insert(Updated::value_type(type, true));
+  }
   return _type_map[type];
 }
 
@@ -561,6 +638,9 @@ update_type(TypeIndex type) {
 InterrogateFunction &InterrogateDatabase::
 update_function(FunctionIndex function) {
   check_latest();
+  if (!_lazy_functions.empty()) {
+    decode_lazy_function(function);
+  }
   return *_function_map[function];
 }
 
@@ -571,6 +651,9 @@ update_function(FunctionIndex function) {
 InterrogateFunctionWrapper &InterrogateDatabase::
 update_wrapper(FunctionWrapperIndex wrapper) {
   check_latest();
+  if (!_lazy_wrappers.empty()) {
+    decode_lazy_wrapper(wrapper);
+  }
   return _wrapper_map[wrapper];
 }
 
@@ -581,6 +664,9 @@ update_wrapper(FunctionWrapperIndex wrapper) {
 InterrogateManifest &InterrogateDatabase::
 update_manifest(ManifestIndex manifest) {
   check_latest();
+  if (_lookups_fresh & LT_manifest_name) {
+    _updated_manifests.insert(Updated::value_type(manifest, true));
+  }
   return _manifest_map[manifest];
 }
 
@@ -591,6 +677,9 @@ update_manifest(ManifestIndex manifest) {
 InterrogateElement &InterrogateDatabase::
 update_element(ElementIndex element) {
   check_latest();
+  if (_lookups_fresh & LT_element_all) {
+    _updated_elements.insert(Updated::value_type(element, true));
+  }
   return _element_map[element];
 }
 
@@ -730,6 +819,12 @@ remap_indices(int first_index, IndexRemapper &remap) {
     (*gei) = remap.map_from(*gei);
   }
 
+  // All of the lookup tables will have to be rebuilt with the new numbers.
+  _lookups_fresh = 0;
+  _updated_types.clear();
+  _updated_manifests.clear();
+  _updated_elements.clear();
+
   return _next_index;
 }
 
@@ -932,6 +1027,65 @@ write(std::ostream &out, InterrogateModuleDef *def) const {
   }
 }
 
+/**
+ * Writes the database to the indicated stream in the binary format, which can
+ * be loaded much faster than the text format written by write().  The stream
+ * should have been opened in binary mode.
+ */
+void InterrogateDatabase::
+write_binary(std::ostream &out, InterrogateModuleDef *def) const {
+  IDFBinaryWriter writer;
+
+  FunctionMap::const_iterator fi;
+  for (fi = _function_map.begin(); fi != _function_map.end(); ++fi) {
+    const InterrogateFunction *function = (*fi).second;
+    writer.begin_record(BT_function, (*fi).first,
+                        function->is_global() ? BF_global : 0,
+                        function->get_name(), function->get_scoped_name());
+    function->output_binary(writer);
+  }
+
+  FunctionWrapperMap::const_iterator wi;
+  for (wi = _wrapper_map.begin(); wi != _wrapper_map.end(); ++wi) {
+    writer.begin_record(BT_wrapper, (*wi).first, 0, (*wi).second.get_name());
+    (*wi).second.output_binary(writer);
+  }
+
+  TypeMap::const_iterator ti;
+  for (ti = _type_map.begin(); ti != _type_map.end(); ++ti) {
+    const InterrogateType &type = (*ti).second;
+    writer.begin_record(BT_type, (*ti).first, type.is_global() ? BF_global : 0,
+                        type.get_name(), type.get_scoped_name(),
+                        type.get_true_name());
+    type.output_binary(writer);
+  }
+
+  ManifestMap::const_iterator mi;
+  for (mi = _manifest_map.begin(); mi != _manifest_map.end(); ++mi) {
+    writer.begin_record(BT_manifest, (*mi).first, 0, (*mi).second.get_name());
+    (*mi).second.output_binary(writer);
+  }
+
+  ElementMap::const_iterator ei;
+  for (ei = _element_map.begin(); ei != _element_map.end(); ++ei) {
+    const InterrogateElement &element = (*ei).second;
+    writer.begin_record(BT_element, (*ei).first,
+                        element.is_global() ? BF_global : 0,
+                        element.get_name(), element.get_scoped_name());
+    element.output_binary(writer);
+  }
+
+  MakeSeqMap::const_iterator si;
+  for (si = _make_seq_map.begin(); si != _make_seq_map.end(); ++si) {
+    writer.begin_record(BT_make_seq, (*si).first, 0, (*si).second.get_name());
+    (*si).second.output_binary(writer);
+  }
+
+  writer.write(out, def->file_identifier,
+               _current_major_version, _current_minor_version,
+               def->library_name, def->library_hash_name, def->module_name);
+}
+
 /**
  * Reads a database from the indicated stream, associated with the indicated
  * module definition and merges it with any existing data in the database,
@@ -947,6 +1101,33 @@ read(std::istream &in, InterrogateModuleDef *def) {
     return false;
   }
 
+  return merge_new(temp, def);
+}
+
+/**
+ * Reads a database from the indicated file in the binary format, associated
+ * with the indicated module definition, and merges it with any existing data
+ * in the database in the same way as read().
+ *
+ * Returns true if the file is read successfully, false if there is an error.
+ */
+bool InterrogateDatabase::
+read_binary(const IDFBinaryFile &file, InterrogateModuleDef *def) {
+  InterrogateDatabase temp;
+  if (!temp.read_new_binary(file, def)) {
+    return false;
+  }
+
+  return merge_new(temp, def);
+}
+
+/**
+ * Renumbers the components of the indicated database, which was just read
+ * from the file associated with the given module definition, and merges them
+ * into this database.  Returns false if the file turns out to be out of date.
+ */
+bool InterrogateDatabase::
+merge_new(InterrogateDatabase &temp, InterrogateModuleDef *def) {
   if (def->first_index == 0 && def->next_index == 0) {
     _next_index = temp.remap_indices(_next_index);
 
@@ -965,80 +1146,249 @@ read(std::istream &in, InterrogateModuleDef *def) {
 }
 
 /**
- * Reads in the latest interrogate data.
+ * Reads in the latest interrogate data.  The requested database files are
+ * read on several threads at once, each into a database of its own, and are
+ * then merged into this one on the calling thread.  The merging is done in
+ * the order in which the modules were requested, so the index numbers come
+ * out the same regardless of which file finished reading first.
  */
 void InterrogateDatabase::
 load_latest() {
-  const DSearchPath &searchpath = interrogatedb_path;
-
   Requests copy_requests;
   copy_requests.swap(_requests);
 
-  Requests::const_iterator ri;
-  for (ri = copy_requests.begin(); ri != copy_requests.end(); ++ri) {
-    InterrogateModuleDef *def = (*ri);
-
-    if (def->database_filename != nullptr) {
-      Filename filename = def->database_filename;
-      Filename pathname = filename;
-      if (!pathname.empty() && pathname[0] != '/') {
-        pathname = searchpath.find_file(pathname);
+  size_t num_requests = copy_requests.size();
+  LoadResults results(num_requests);
+  for (size_t i = 0; i < num_requests; ++i) {
+    LoadResult &result = results[i];
+    result._def = copy_requests[i];
+    result._error_flag = false;
+    result._file_major_version = 0;
+    result._file_minor_version = 0;
+    result._temp = nullptr;
+    result._file = nullptr;
+  }
+
+#ifdef HAVE_THREADS
+  size_t num_threads = std::min((size_t)std::thread::hardware_concurrency(),
+                                num_requests);
+  num_threads = std::min(num_threads, max_load_threads);
+  if (num_threads > 1) {
+    // This thread reads files too, along with the threads it starts.  If no
+    // more threads can be started, it reads whatever the others don't get to.
+    std::atomic<size_t> next_request(0);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    try {
+      for (size_t t = 1; t < num_threads; ++t) {
+        threads.emplace_back(&InterrogateDatabase::read_requests, this,
+                             std::ref(results), std::ref(next_request));
       }
+    } catch (const std::system_error &) {
+      // Make do with the threads we have.
+    }
+    read_requests(results, next_request);
+    for (size_t t = 0; t < threads.size(); ++t) {
+      threads[t].join();
+    }
+  } else
+#endif  // HAVE_THREADS
+  {
+    for (size_t i = 0; i < num_requests; ++i) {
+      read_request(results[i]);
+    }
+  }
+
+  for (size_t i = 0; i < num_requests; ++i) {
+    merge_request(results[i]);
+  }
 
-      if (pathname.empty()) {
-        std::cerr
-          << "Unable to find " << filename << " on " << searchpath << "\n";
-        set_error_flag(true);
+  _requests.clear();
+}
+
+#ifdef HAVE_THREADS
+/**
+ * The body of each of the threads started by load_latest().  Reads requested
+ * database files until there are none left.
+ */
+void InterrogateDatabase::
+read_requests(LoadResults &results, std::atomic<size_t> &next_request) const {
+  size_t i = next_request++;
+  while (i < results.size()) {
+    read_request(results[i]);
+    i = next_request++;
+  }
+}
+#endif  // HAVE_THREADS
+
+/**
+ * Locates and reads the database file of one requested module into a new
+ * database of its own, or in lazy loading mode, just maps it.  This touches
+ * nothing but the result, so it may be called on any thread; any messages
+ * are saved in the result to be reported by merge_request().
+ */
+void InterrogateDatabase::
+read_request(LoadResult &result) const {
+  InterrogateModuleDef *def = result._def;
+  if (def->database_filename == nullptr) {
+    return;
+  }
+
+  const DSearchPath &searchpath = interrogatedb_path;
+  std::ostringstream messages;
+
+  Filename filename = def->database_filename;
+  Filename pathname = filename;
+  if (!pathname.empty() && pathname[0] != '/') {
+    pathname = searchpath.find_file(pathname);
+  }
+  result._pathname = pathname.get_fullpath();
+
+  if (pathname.empty()) {
+    messages
+      << "Unable to find " << filename << " on " << searchpath << "\n";
+    result._error_flag = true;
+
+  } else {
+
+    std::ifstream input;
+    pathname.set_text();
+    if (!pathname.open_read(input)) {
+      messages << "Unable to read " << pathname << ".\n";
+      result._error_flag = true;
+
+    } else if (IDFBinaryFile::is_binary(input)) {
+      // The file is in the binary format; map it instead of parsing it from
+      // the stream.
+      input.close();
+      IDFBinaryFile *file = new IDFBinaryFile;
+      if (!file->open(pathname)) {
+        messages << "Invalid interrogate database " << pathname << ".\n";
+        result._error_flag = true;
+        delete file;
 
       } else {
+        result._file_major_version = file->get_major_version();
+        result._file_minor_version = file->get_minor_version();
+
+        if (!check_file_header(pathname, file->get_file_identifier(),
+                               result, messages)) {
+          delete file;
 
-        std::ifstream input;
-        pathname.set_text();
-        if (!pathname.open_read(input)) {
-          std::cerr << "Unable to read " << pathname << ".\n";
-          set_error_flag(true);
+        } else if (_lazy_loading) {
+          // merge_request() passes the file on to read_lazy(), which keeps
+          // it mapped so that its records can be decoded later.
+          result._file = file;
 
         } else {
-          int file_identifier;
-          input >> file_identifier
-                >> _file_major_version >> _file_minor_version;
-
-          if (def->file_identifier != 0 &&
-              file_identifier != def->file_identifier) {
-            std::cerr//interrogatedb_cat->warning()
-              << "Interrogate data in " << pathname
-              << " is out of sync with the compiled-in data"
-              << " (" << file_identifier << " != " << def->file_identifier << ").\n";
-            set_error_flag(true);
+          file_major_version = result._file_major_version;
+          file_minor_version = result._file_minor_version;
+
+          result._temp = new InterrogateDatabase;
+          if (!result._temp->read_new_binary(*file, def)) {
+            messages << "Error reading " << pathname << ".\n";
+            result._error_flag = true;
+            delete result._temp;
+            result._temp = nullptr;
           }
+          delete file;
+        }
+      }
 
-          if (_file_major_version != _current_major_version ||
-              _file_minor_version > _current_minor_version) {
-            std::cerr
-              << "Cannot read interrogate data in " << pathname
-              << "; database is version " << _file_major_version << "."
-              << _file_minor_version << " while we are expecting "
-              << _current_major_version << "." << _current_minor_version
-              << ".\n";
-            set_error_flag(true);
-
-          } else {
-            /*if (interrogatedb_cat->is_debug()) {
-              interrogatedb_cat->debug()
-                << "Reading " << filename << "\n";
-            }*/
-            if (!read(input, def)) {
-              std::cerr
-                << "Error reading " << pathname << ".\n";
-              set_error_flag(true);
-            }
-          }
+    } else {
+      int file_identifier;
+      input >> file_identifier
+            >> result._file_major_version >> result._file_minor_version;
+
+      if (check_file_header(pathname, file_identifier, result, messages)) {
+        /*if (interrogatedb_cat->is_debug()) {
+          interrogatedb_cat->debug()
+            << "Reading " << filename << "\n";
+        }*/
+
+        // The components consult the version number while they are read.
+        file_major_version = result._file_major_version;
+        file_minor_version = result._file_minor_version;
+
+        result._temp = new InterrogateDatabase;
+        if (!result._temp->read_new(input, def)) {
+          messages << "Error reading " << pathname << ".\n";
+          result._error_flag = true;
+          delete result._temp;
+          result._temp = nullptr;
         }
       }
     }
   }
 
-  _requests.clear();
+  result._messages = messages.str();
+}
+
+/**
+ * Reports the messages saved by read_request() for one requested module, and
+ * merges the data that was read into this database.
+ */
+void InterrogateDatabase::
+merge_request(LoadResult &result) {
+  std::cerr << result._messages;
+  if (result._error_flag) {
+    set_error_flag(true);
+  }
+
+  file_major_version = result._file_major_version;
+  file_minor_version = result._file_minor_version;
+
+  if (result._file != nullptr) {
+    // read_lazy() takes ownership of the file.
+    if (!read_lazy(result._file, result._def)) {
+      std::cerr
+        << "Error reading " << result._pathname << ".\n";
+      set_error_flag(true);
+    }
+
+  } else if (result._temp != nullptr) {
+    if (!merge_new(*result._temp, result._def)) {
+      std::cerr
+        << "Error reading " << result._pathname << ".\n";
+      set_error_flag(true);
+    }
+    delete result._temp;
+  }
+}
+
+/**
+ * Checks the identifier and version number that were read from the header of
+ * the indicated database file against the compiled-in module definition.
+ * Writes any mismatch to the given stream and flags the error in the result.
+ * Returns true if the file can be read, false if its version is not
+ * supported.
+ */
+bool InterrogateDatabase::
+check_file_header(const Filename &pathname, int file_identifier,
+                  LoadResult &result, std::ostream &messages) {
+  InterrogateModuleDef *def = result._def;
+  if (def->file_identifier != 0 &&
+      file_identifier != def->file_identifier) {
+    messages//interrogatedb_cat->warning()
+      << "Interrogate data in " << pathname
+      << " is out of sync with the compiled-in data"
+      << " (" << file_identifier << " != " << def->file_identifier << ").\n";
+    result._error_flag = true;
+  }
+
+  if (result._file_major_version != _current_major_version ||
+      result._file_minor_version > _current_minor_version) {
+    messages
+      << "Cannot read interrogate data in " << pathname
+      << "; database is version " << result._file_major_version << "."
+      << result._file_minor_version << " while we are expecting "
+      << _current_major_version << "." << _current_minor_version
+      << ".\n";
+    result._error_flag = true;
+    return false;
+  }
+
+  return true;
 }
 
 /**
@@ -1190,6 +1540,299 @@ read_new(std::istream &in, InterrogateModuleDef *def) {
   return true;
 }
 
+/**
+ * Reads the indicated binary database file into the newly-created database.
+ * It is an error if the database already has some data in it.
+ */
+bool InterrogateDatabase::
+read_new_binary(const IDFBinaryFile &file, InterrogateModuleDef *def) {
+  IDFBinaryReader header = file.get_header_reader();
+  header.get_string(def->library_name);
+  header.get_string(def->library_hash_name);
+  header.get_string(def->module_name);
+  if (header.is_error()) {
+    return false;
+  }
+
+  int num_functions = file.get_num_records(BT_function);
+  for (int n = 0; n < num_functions; ++n) {
+    IDFBinaryReader in = file.get_record(BT_function, n);
+    InterrogateFunction *function = new InterrogateFunction(def);
+    function->input_binary(in);
+    if (in.is_error()) {
+      delete function;
+      return false;
+    }
+    add_function(file.get_record_index(BT_function, n), function);
+  }
+
+  int num_wrappers = file.get_num_records(BT_wrapper);
+  for (int n = 0; n < num_wrappers; ++n) {
+    IDFBinaryReader in = file.get_record(BT_wrapper, n);
+    InterrogateFunctionWrapper wrapper(def);
+    wrapper.input_binary(in);
+    if (in.is_error()) {
+      return false;
+    }
+    add_wrapper(file.get_record_index(BT_wrapper, n), wrapper);
+  }
+
+  int num_types = file.get_num_records(BT_type);
+  for (int n = 0; n < num_types; ++n) {
+    IDFBinaryReader in = file.get_record(BT_type, n);
+    InterrogateType type(def);
+    type.input_binary(in);
+    if (in.is_error()) {
+      return false;
+    }
+    add_type(file.get_record_index(BT_type, n), type);
+  }
+
+  int num_manifests = file.get_num_records(BT_manifest);
+  for (int n = 0; n < num_manifests; ++n) {
+    IDFBinaryReader in = file.get_record(BT_manifest, n);
+    InterrogateManifest manifest(def);
+    manifest.input_binary(in);
+    if (in.is_error()) {
+      return false;
+    }
+    add_manifest(file.get_record_index(BT_manifest, n), manifest);
+  }
+
+  int num_elements = file.get_num_records(BT_element);
+  for (int n = 0; n < num_elements; ++n) {
+    IDFBinaryReader in = file.get_record(BT_element, n);
+    InterrogateElement element(def);
+    element.input_binary(in);
+    if (in.is_error()) {
+      return false;
+    }
+    add_element(file.get_record_index(BT_element, n), element);
+  }
+
+  int num_make_seqs = file.get_num_records(BT_make_seq);
+  for (int n = 0; n < num_make_seqs; ++n) {
+    IDFBinaryReader in = file.get_record(BT_make_seq, n);
+    InterrogateMakeSeq make_seq(def);
+    make_seq.input_binary(in);
+    if (in.is_error()) {
+      return false;
+    }
+    add_make_seq(file.get_record_index(BT_make_seq, n), make_seq);
+  }
+
+  return true;
+}
+
+/**
+ * Reads the index tables of the indicated binary database file, associated
+ * with the indicated module definition, and adds the components listed in
+ * them to the database without decoding the types, functions and function
+ * wrappers themselves.  These are decoded later by decode_lazy_type() and so
+ * on, the first time they are accessed.  The other components are few, and
+ * are read right away.
+ *
+ * This takes ownership of the file, which is closed once all of its records
+ * have been decoded.  Returns true if the file is read successfully, false if
+ * there is an error, in which case nothing is added to the database.
+ */
+bool InterrogateDatabase::
+read_lazy(IDFBinaryFile *file, InterrogateModuleDef *def) {
+  IDFBinaryReader header = file->get_header_reader();
+  header.get_string(def->library_name);
+  header.get_string(def->library_hash_name);
+  header.get_string(def->module_name);
+  if (header.is_error()) {
+    delete file;
+    return false;
+  }
+
+  // Assign the new index numbers in the same order as remap_indices() would.
+  // The index tables are already sorted by index number.
+  static const IDFBinaryTable remap_order[] = {
+    BT_wrapper, BT_function, BT_type, BT_manifest, BT_element, BT_make_seq,
+  };
+
+  IndexRemapper *remap = new IndexRemapper;
+  int next_index = (def->first_index == 0 && def->next_index == 0)
+    ? _next_index : def->first_index;
+  for (size_t i = 0; i < sizeof(remap_order) / sizeof(remap_order[0]); ++i) {
+    IDFBinaryTable table = remap_order[i];
+    int num_records = file->get_num_records(table);
+    for (int n = 0; n < num_records; ++n) {
+      remap->add_mapping(file->get_record_index(table, n), next_index);
+      next_index++;
+    }
+  }
+
+  if (def->first_index != 0 || def->next_index != 0) {
+    if (next_index != def->next_index) {
+      std::cerr
+        << "Module database file " << def->database_filename
+        << " is out of date.\n";
+      delete remap;
+      delete file;
+      return false;
+    }
+  }
+
+  // Shared types are collapsed together with the types we already have, as
+  // in merge_from().  The index tables store the names we need to find them.
+  map<string, TypeIndex> types_by_name;
+  get_types_by_true_name(types_by_name);
+
+  int num_types = file->get_num_records(BT_type);
+  std::vector<TypeIndex> merge_types(num_types, 0);
+  for (int n = 0; n < num_types; ++n) {
+    if (*file->get_record_name(BT_type, n, BN_name) != '\0') {
+      map<string, TypeIndex>::iterator ni;
+      ni = types_by_name.find(file->get_record_name(BT_type, n, BN_true_name));
+      if (ni != types_by_name.end()) {
+        merge_types[n] = (*ni).second;
+        remap->add_mapping(file->get_record_index(BT_type, n), (*ni).second);
+      }
+    }
+  }
+
+  // Decode everything that can't wait before anything is added to the
+  // database, so that a damaged file leaves the database untouched.
+  bool okflag = true;
+  std::vector<InterrogateType> decoded_types;
+  for (int n = 0; n < num_types && okflag; ++n) {
+    if (merge_types[n] != 0) {
+      IDFBinaryReader in = file->get_record(BT_type, n);
+      decoded_types.push_back(InterrogateType(def));
+      decoded_types.back().input_binary(in);
+      okflag = !in.is_error();
+      decoded_types.back().remap_indices(*remap);
+    }
+  }
+
+  int num_manifests = file->get_num_records(BT_manifest);
+  std::vector<InterrogateManifest> manifests;
+  for (int n = 0; n < num_manifests && okflag; ++n) {
+    IDFBinaryReader in = file->get_record(BT_manifest, n);
+    manifests.push_back(InterrogateManifest(def));
+    manifests.back().input_binary(in);
+    okflag = !in.is_error();
+    manifests.back().remap_indices(*remap);
+  }
+
+  int num_elements = file->get_num_records(BT_element);
+  std::vector<InterrogateElement> elements;
+  for (int n = 0; n < num_elements && okflag; ++n) {
+    IDFBinaryReader in = file->get_record(BT_element, n);
+    elements.push_back(InterrogateElement(def));
+    elements.back().input_binary(in);
+    okflag = !in.is_error();
+    elements.back().remap_indices(*remap);
+  }
+
+  int num_make_seqs = file->get_num_records(BT_make_seq);
+  std::vector<InterrogateMakeSeq> make_seqs;
+  for (int n = 0; n < num_make_seqs && okflag; ++n) {
+    IDFBinaryReader in = file->get_record(BT_make_seq, n);
+    make_seqs.push_back(InterrogateMakeSeq(def));
+    make_seqs.back().input_binary(in);
+    okflag = !in.is_error();
+    make_seqs.back().remap_indices(*remap);
+  }
+
+  if (!okflag) {
+    delete remap;
+    delete file;
+    return false;
+  }
+
+  if (def->first_index == 0 && def->next_index == 0) {
+    _next_index = next_index;
+  }
+
+  LazyModule *module = new LazyModule;
+  module->_file = file;
+  module->_def = def;
+  module->_remap = remap;
+  // This reference keeps the module alive until all of its records have been
+  // listed; it is freed below if none of them are left to be decoded.
+  module->_num_records = 1;
+  _lazy_modules.push_back(module);
+
+  std::vector<InterrogateType>::iterator di = decoded_types.begin();
+  for (int n = 0; n < num_types; ++n) {
+    bool is_global = (file->get_record_flags(BT_type, n) & BF_global) != 0;
+
+    if (merge_types[n] == 0) {
+      // Here's a new type; we'll decode it when it is asked for.
+      TypeIndex index = remap->map_from(file->get_record_index(BT_type, n));
+      LazyRecord &record = _lazy_types[index];
+      record._module = module;
+      record._n = n;
+      module->_num_records++;
+
+      if (is_global) {
+        _global_types.push_back(index);
+      }
+      _all_types.push_back(index);
+
+      if (_lookups_fresh & LT_type_all) {
+        refresh_type_lookups(index);
+      }
+
+    } else {
+      // Here's a type to merge, which we decoded above.
+      InterrogateType &this_type = update_type(merge_types[n]);
+      if (!this_type.is_global() && is_global) {
+        _global_types.push_back(merge_types[n]);
+      }
+      this_type.merge_with(*di);
+      ++di;
+    }
+  }
+
+  int num_functions = file->get_num_records(BT_function);
+  for (int n = 0; n < num_functions; ++n) {
+    FunctionIndex index =
+      remap->map_from(file->get_record_index(BT_function, n));
+    LazyRecord &record = _lazy_functions[index];
+    record._module = module;
+    record._n = n;
+    module->_num_records++;
+
+    if (file->get_record_flags(BT_function, n) & BF_global) {
+      _global_functions.push_back(index);
+    }
+    _all_functions.push_back(index);
+  }
+
+  int num_wrappers = file->get_num_records(BT_wrapper);
+  for (int n = 0; n < num_wrappers; ++n) {
+    FunctionWrapperIndex index =
+      remap->map_from(file->get_record_index(BT_wrapper, n));
+    LazyRecord &record = _lazy_wrappers[index];
+    record._module = module;
+    record._n = n;
+    module->_num_records++;
+  }
+
+  for (int n = 0; n < num_manifests; ++n) {
+    add_manifest(remap->map_from(file->get_record_index(BT_manifest, n)),
+                 manifests[n]);
+  }
+
+  for (int n = 0; n < num_elements; ++n) {
+    add_element(remap->map_from(file->get_record_index(BT_element, n)),
+                elements[n]);
+  }
+
+  for (int n = 0; n < num_make_seqs; ++n) {
+    add_make_seq(remap->map_from(file->get_record_index(BT_make_seq, n)),
+                 make_seqs[n]);
+  }
+
+  release_lazy_record(module);
+  return true;
+}
+
 /**
  * Copies all the data from the indicated database into this one.  It is an
  * error if any index numbers are shared between the two databases.
@@ -1202,17 +1845,11 @@ merge_from(const InterrogateDatabase &other) {
   // First, we need to build a set of types by name, so we know what types we
   // already have.
   map<string, TypeIndex> types_by_name;
-
-  TypeMap::const_iterator ti;
-  for (ti = _type_map.begin(); ti != _type_map.end(); ++ti) {
-    const InterrogateType &type = (*ti).second;
-    if (type.has_true_name()) {
-      types_by_name[type.get_true_name()] = (*ti).first;
-    }
-  }
+  get_types_by_true_name(types_by_name);
 
   // Now go through the other set of types and determine the mapping into this
   // set.
+  TypeMap::const_iterator ti;
   for (ti = other._type_map.begin(); ti != other._type_map.end(); ++ti) {
     TypeIndex other_type_index = (*ti).first;
     const InterrogateType &other_type = (*ti).second;
@@ -1307,8 +1944,141 @@ merge_from(const InterrogateDatabase &other) {
     add_make_seq(other_make_seq_index, other_make_seq);
     update_make_seq(other_make_seq_index).remap_indices(remap);
   }
+}
+
+/**
+ * Fills the indicated map with the index of each type in the database that
+ * has a true name, keyed by that name.  This includes the types that have not
+ * yet been decoded in lazy loading mode.
+ */
+void InterrogateDatabase::
+get_types_by_true_name(map<string, TypeIndex> &types) const {
+  LazyRecords::const_iterator li;
+  for (li = _lazy_types.begin(); li != _lazy_types.end(); ++li) {
+    const LazyRecord &record = (*li).second;
+    const char *true_name =
+      record._module->_file->get_record_name(BT_type, record._n, BN_true_name);
+    if (*true_name != '\0') {
+      types[true_name] = (*li).first;
+    }
+  }
 
-  _lookups_fresh = 0;
+  TypeMap::const_iterator ti;
+  for (ti = _type_map.begin(); ti != _type_map.end(); ++ti) {
+    const InterrogateType &type = (*ti).second;
+    if (type.has_true_name()) {
+      types[type.get_true_name()] = (*ti).first;
+    }
+  }
+}
+
+/**
+ * Decodes the indicated type from its database file, if it was read in lazy
+ * loading mode and has not been decoded yet, and adds it to the database.
+ * Returns true if the type was decoded, false if there was nothing to decode
+ * or if the record could not be read.  A record that could not be read stays
+ * listed, so that the type can still be found by name.
+ */
+bool InterrogateDatabase::
+decode_lazy_type(TypeIndex type) {
+  LazyRecords::iterator li = _lazy_types.find(type);
+  if (li == _lazy_types.end()) {
+    return false;
+  }
+  LazyModule *module = (*li).second._module;
+  IDFBinaryReader in = module->_file->get_record(BT_type, (*li).second._n);
+
+  InterrogateType new_type(module->_def);
+  new_type.input_binary(in);
+  if (in.is_error()) {
+    std::cerr << "Error decoding type " << type << ".\n";
+    set_error_flag(true);
+    return false;
+  }
+  new_type.remap_indices(*module->_remap);
+  _lazy_types.erase(li);
+  _type_map[type] = new_type;
+  release_lazy_record(module);
+  return true;
+}
+
+/**
+ * Decodes the indicated function from its database file, if it was read in
+ * lazy loading mode and has not been decoded yet, and adds it to the
+ * database.  Returns true if the function was decoded, false if there was
+ * nothing to decode or if the record could not be read.
+ */
+bool InterrogateDatabase::
+decode_lazy_function(FunctionIndex function) {
+  LazyRecords::iterator li = _lazy_functions.find(function);
+  if (li == _lazy_functions.end()) {
+    return false;
+  }
+  LazyModule *module = (*li).second._module;
+  IDFBinaryReader in = module->_file->get_record(BT_function, (*li).second._n);
+
+  InterrogateFunction *new_function = new InterrogateFunction(module->_def);
+  new_function->input_binary(in);
+  if (in.is_error()) {
+    std::cerr << "Error decoding function " << function << ".\n";
+    set_error_flag(true);
+    delete new_function;
+    return false;
+  }
+  new_function->remap_indices(*module->_remap);
+  _lazy_functions.erase(li);
+  _function_map[function] = new_function;
+  release_lazy_record(module);
+  return true;
+}
+
+/**
+ * Decodes the indicated function wrapper from its database file, if it was
+ * read in lazy loading mode and has not been decoded yet, and adds it to the
+ * database.  Returns true if the wrapper was decoded, false if there was
+ * nothing to decode or if the record could not be read.
+ */
+bool InterrogateDatabase::
+decode_lazy_wrapper(FunctionWrapperIndex wrapper) {
+  LazyRecords::iterator li = _lazy_wrappers.find(wrapper);
+  if (li == _lazy_wrappers.end()) {
+    return false;
+  }
+  LazyModule *module = (*li).second._module;
+  IDFBinaryReader in = module->_file->get_record(BT_wrapper, (*li).second._n);
+
+  InterrogateFunctionWrapper new_wrapper(module->_def);
+  new_wrapper.input_binary(in);
+  if (in.is_error()) {
+    std::cerr << "Error decoding function wrapper " << wrapper << ".\n";
+    set_error_flag(true);
+    return false;
+  }
+  new_wrapper.remap_indices(*module->_remap);
+  _lazy_wrappers.erase(li);
+  _wrapper_map[wrapper] = new_wrapper;
+  release_lazy_record(module);
+  return true;
+}
+
+/**
+ * Called when one of the records of the indicated module has been decoded.
+ * Once none are left, the module is freed and its file is unmapped.
+ */
+void InterrogateDatabase::
+release_lazy_record(LazyModule *module) {
+  if (--module->_num_records > 0) {
+    return;
+  }
+
+  LazyModules::iterator mi =
+    std::find(_lazy_modules.begin(), _lazy_modules.end(), module);
+  assert(mi != _lazy_modules.end());
+  _lazy_modules.erase(mi);
+
+  delete module->_remap;
+  delete module->_file;
+  delete module;
 }
 
 /**
@@ -1387,9 +2157,17 @@ binary_search_wrapper_hash(InterrogateUniqueNameDef *begin,
 void InterrogateDatabase::
 freshen_types_by_name() {
   _types_by_name.clear();
+  LazyRecords::const_iterator li;
+  for (li = _lazy_types.begin(); li != _lazy_types.end(); ++li) {
+    const LazyRecord &record = (*li).second;
+    const IDFBinaryFile *file = record._module->_file;
+    _types_by_name.add(file->get_record_name(BT_type, record._n, BN_name),
+                       (*li).first);
+  }
+
   TypeMap::const_iterator ti;
   for (ti = _type_map.begin(); ti != _type_map.end(); ++ti) {
-    _types_by_name[(*ti).second.get_name()] = (*ti).first;
+    _types_by_name.add((*ti).second.get_name(), (*ti).first);
   }
 }
 
@@ -1399,9 +2177,17 @@ freshen_types_by_name() {
 void InterrogateDatabase::
 freshen_types_by_scoped_name() {
   _types_by_scoped_name.clear();
+  LazyRecords::const_iterator li;
+  for (li = _lazy_types.begin(); li != _lazy_types.end(); ++li) {
+    const LazyRecord &record = (*li).second;
+    const IDFBinaryFile *file = record._module->_file;
+    _types_by_scoped_name.add(file->get_record_name(BT_type, record._n, BN_scoped_name),
+                              (*li).first);
+  }
+
   TypeMap::const_iterator ti;
   for (ti = _type_map.begin(); ti != _type_map.end(); ++ti) {
-    _types_by_scoped_name[(*ti).second.get_scoped_name()] = (*ti).first;
+    _types_by_scoped_name.add((*ti).second.get_scoped_name(), (*ti).first);
   }
 }
 
@@ -1411,9 +2197,17 @@ freshen_types_by_scoped_name() {
 void InterrogateDatabase::
 freshen_types_by_true_name() {
   _types_by_true_name.clear();
+  LazyRecords::const_iterator li;
+  for (li = _lazy_types.begin(); li != _lazy_types.end(); ++li) {
+    const LazyRecord &record = (*li).second;
+    const IDFBinaryFile *file = record._module->_file;
+    _types_by_true_name.add(file->get_record_name(BT_type, record._n, BN_true_name),
+                            (*li).first);
+  }
+
   TypeMap::const_iterator ti;
   for (ti = _type_map.begin(); ti != _type_map.end(); ++ti) {
-    _types_by_true_name[(*ti).second.get_true_name()] = (*ti).first;
+    _types_by_true_name.add((*ti).second.get_true_name(), (*ti).first);
   }
 }
 
@@ -1425,7 +2219,7 @@ freshen_manifests_by_name() {
   _manifests_by_name.clear();
   ManifestMap::const_iterator ti;
   for (ti = _manifest_map.begin(); ti != _manifest_map.end(); ++ti) {
-    _manifests_by_name[(*ti).second.get_name()] = (*ti).first;
+    _manifests_by_name.add((*ti).second.get_name(), (*ti).first);
   }
 }
 
@@ -1437,7 +2231,7 @@ freshen_elements_by_name() {
   _elements_by_name.clear();
   ElementMap::const_iterator ti;
   for (ti = _element_map.begin(); ti != _element_map.end(); ++ti) {
-    _elements_by_name[(*ti).second.get_name()] = (*ti).first;
+    _elements_by_name.add((*ti).second.get_name(), (*ti).first);
   }
 }
 
@@ -1449,7 +2243,7 @@ freshen_elements_by_scoped_name() {
   _elements_by_scoped_name.clear();
   ElementMap::const_iterator ti;
   for (ti = _element_map.begin(); ti != _element_map.end(); ++ti) {
-    _elements_by_scoped_name[(*ti).second.get_scoped_name()] = (*ti).first;
+    _elements_by_scoped_name.add((*ti).second.get_scoped_name(), (*ti).first);
   }
 }
 
@@ -1461,15 +2255,182 @@ int InterrogateDatabase::
 lookup(const string &name, Lookup &lookup, LookupType type,
        void (InterrogateDatabase::*freshen)()) {
   if ((_lookups_fresh & (int)type) == 0) {
-    // The lookup table isn't fresh; we need to freshen it.
+    // The lookup table hasn't been built yet; we need to freshen it.
     (this->*freshen)();
     _lookups_fresh |= (int)type;
   }
+  refresh_lookups();
+
+  return lookup.find(name);
+}
+
+/**
+ * Brings the lookup tables that have been built up to date with the
+ * indicated type, which may have been added, changed or removed.
+ */
+void InterrogateDatabase::
+refresh_type_lookups(TypeIndex type) {
+  TypeMap::const_iterator ti = _type_map.find(type);
+  LazyRecords::const_iterator li;
+  if (ti != _type_map.end()) {
+    const InterrogateType &itype = (*ti).second;
+    if (_lookups_fresh & LT_type_name) {
+      _types_by_name.add(itype.get_name(), type);
+    }
+    if (_lookups_fresh & LT_type_scoped_name) {
+      _types_by_scoped_name.add(itype.get_scoped_name(), type);
+    }
+    if (_lookups_fresh & LT_type_true_name) {
+      _types_by_true_name.add(itype.get_true_name(), type);
+    }
 
-  Lookup::const_iterator li;
-  li = lookup.find(name);
-  if (li != lookup.end()) {
-    return (*li).second;
+  } else if ((li = _lazy_types.find(type)) != _lazy_types.end()) {
+    const LazyRecord &record = (*li).second;
+    const IDFBinaryFile *file = record._module->_file;
+    if (_lookups_fresh & LT_type_name) {
+      _types_by_name.add(file->get_record_name(BT_type, record._n, BN_name),
+                         type);
+    }
+    if (_lookups_fresh & LT_type_scoped_name) {
+      _types_by_scoped_name.add(file->get_record_name(BT_type, record._n, BN_scoped_name),
+                                type);
+    }
+    if (_lookups_fresh & LT_type_true_name) {
+      _types_by_true_name.add(file->get_record_name(BT_type, record._n, BN_true_name),
+                              type);
+    }
+
+  } else {
+    _types_by_name.remove(type);
+    _types_by_scoped_name.remove(type);
+    _types_by_true_name.remove(type);
   }
-  return 0;
+}
+
+/**
+ * Brings the lookup table of manifests by name up to date with the indicated
+ * manifest, if it has been built.
+ */
+void InterrogateDatabase::
+refresh_manifest_lookups(ManifestIndex manifest) {
+  ManifestMap::const_iterator mi = _manifest_map.find(manifest);
+  if (mi == _manifest_map.end()) {
+    _manifests_by_name.remove(manifest);
+
+  } else if (_lookups_fresh & LT_manifest_name) {
+    _manifests_by_name.add((*mi).second.get_name(), manifest);
+  }
+}
+
+/**
+ * Brings the lookup tables of elements that have been built up to date with
+ * the indicated element.
+ */
+void InterrogateDatabase::
+refresh_element_lookups(ElementIndex element) {
+  ElementMap::const_iterator ei = _element_map.find(element);
+  if (ei == _element_map.end()) {
+    _elements_by_name.remove(element);
+    _elements_by_scoped_name.remove(element);
+
+  } else {
+    const InterrogateElement &ielement = (*ei).second;
+    if (_lookups_fresh & LT_element_name) {
+      _elements_by_name.add(ielement.get_name(), element);
+    }
+    if (_lookups_fresh & LT_element_scoped_name) {
+      _elements_by_scoped_name.add(ielement.get_scoped_name(), element);
+    }
+  }
+}
+
+/**
+ * Updates the lookup tables for the components that have been handed out by
+ * update_*() since the last time, as their names may have been changed.
+ */
+void InterrogateDatabase::
+refresh_lookups() {
+  Updated::const_iterator ui;
+  for (ui = _updated_types.begin(); ui != _updated_types.end(); ++ui) {
+    refresh_type_lookups((*ui).first);
+  }
+  _updated_types.clear();
+
+  for (ui = _updated_manifests.begin(); ui != _updated_manifests.end(); ++ui) {
+    refresh_manifest_lookups((*ui).first);
+  }
+  _updated_manifests.clear();
+
+  for (ui = _updated_elements.begin(); ui != _updated_elements.end(); ++ui) {
+    refresh_element_lookups((*ui).first);
+  }
+  _updated_elements.clear();
+}
+
+/**
+ * Adds an entry to the lookup table, listing the indicated index under the
+ * given name.  If the index was already listed under another name, that
+ * entry is replaced.
+ */
+void InterrogateDatabase::Lookup::
+add(const string &name, int index) {
+  Keys::iterator ki = _keys.find(index);
+  if (ki != _keys.end()) {
+    if (*(*ki).second == name) {
+      return;
+    }
+    remove(index);
+  }
+
+  Names::iterator ni = _names.insert(Names::value_type(name, index));
+  _keys[index] = &(*ni).first;
+}
+
+/**
+ * Removes the entry for the indicated index from the lookup table, if there
+ * is one.
+ */
+void InterrogateDatabase::Lookup::
+remove(int index) {
+  Keys::iterator ki = _keys.find(index);
+  if (ki == _keys.end()) {
+    return;
+  }
+
+  std::pair<Names::iterator, Names::iterator> range;
+  range = _names.equal_range(*(*ki).second);
+  for (Names::iterator ni = range.first; ni != range.second; ++ni) {
+    if ((*ni).second == index) {
+      _names.erase(ni);
+      break;
+    }
+  }
+  _keys.erase(ki);
+}
+
+/**
+ * Returns the index listed under the indicated name, or 0 if there is none.
+ * If several components share the name, the one with the highest index is
+ * returned, as it always has been.
+ */
+int InterrogateDatabase::Lookup::
+find(const string &name) const {
+  int index = 0;
+  std::pair<Names::const_iterator, Names::const_iterator> range;
+  range = _names.equal_range(name);
+  for (Names::const_iterator ni = range.first; ni != range.second; ++ni) {
+    if ((*ni).second > index) {
+      index = (*ni).second;
+    }
+  }
+  return index;
+}
+
+/**
+ * Empties the lookup table.
+ */
+void InterrogateDatabase::Lookup::
+clear() {
+  _names.clear();
+  _keys.clear();
 }
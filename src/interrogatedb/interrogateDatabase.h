@@ -24,10 +24,15 @@
 #include "interrogateElement.h"
 #include "interrogateMakeSeq.h"
 #include "interrogate_request.h"
+#include "denseIndexMap.h"
 
+#include <atomic>
 #include <map>
+#include <unordered_map>
 
 class IndexRemapper;
+class IDFBinaryFile;
+class Filename;
 
 /**
  * This stores all of the interrogate data and handles reading the data from a
@@ -36,10 +41,12 @@ class IndexRemapper;
 class EXPCL_INTERROGATEDB InterrogateDatabase {
 private:
   InterrogateDatabase();
+  ~InterrogateDatabase();
 
 public:
   static InterrogateDatabase *get_ptr();
   void request_module(InterrogateModuleDef *def);
+  void set_lazy_loading(bool lazy_loading);
 
 public:
   // Functions to read the database.
@@ -109,14 +116,50 @@ public:
   void write_text(std::ostream &out) const;
 
   void write(std::ostream &out, InterrogateModuleDef *def) const;
+  void write_binary(std::ostream &out, InterrogateModuleDef *def) const;
   bool read(std::istream &in, InterrogateModuleDef *def);
+  bool read_binary(const IDFBinaryFile &file, InterrogateModuleDef *def);
 
 private:
   INLINE void check_latest();
+
+  class LazyModule;
+
+  // The outcome of reading the database file of one requested module, which
+  // load_latest() may do on another thread.  It holds either the data that
+  // was read, or in lazy loading mode, the mapped file.
+  class LoadResult {
+  public:
+    InterrogateModuleDef *_def;
+    std::string _pathname;
+    std::string _messages;
+    bool _error_flag;
+    int _file_major_version;
+    int _file_minor_version;
+    InterrogateDatabase *_temp;
+    IDFBinaryFile *_file;
+  };
+  typedef std::vector<LoadResult> LoadResults;
+
   void load_latest();
+  void read_requests(LoadResults &results,
+                     std::atomic<size_t> &next_request) const;
+  void read_request(LoadResult &result) const;
+  void merge_request(LoadResult &result);
 
+  static bool check_file_header(const Filename &pathname, int file_identifier,
+                                LoadResult &result, std::ostream &messages);
   bool read_new(std::istream &in, InterrogateModuleDef *def);
+  bool read_new_binary(const IDFBinaryFile &file, InterrogateModuleDef *def);
+  bool read_lazy(IDFBinaryFile *file, InterrogateModuleDef *def);
+  bool merge_new(InterrogateDatabase &temp, InterrogateModuleDef *def);
   void merge_from(const InterrogateDatabase &other);
+  void get_types_by_true_name(std::map<std::string, TypeIndex> &types) const;
+
+  bool decode_lazy_type(TypeIndex type);
+  bool decode_lazy_function(FunctionIndex function);
+  bool decode_lazy_wrapper(FunctionWrapperIndex wrapper);
+  void release_lazy_record(LazyModule *module);
 
   bool find_module(FunctionWrapperIndex wrapper,
                    InterrogateModuleDef *&def, int &module_index);
@@ -126,19 +169,19 @@ private:
                                  const std::string &wrapper_hash_name);
 
   // This data is loaded from the various database files.
-  typedef std::map<TypeIndex, InterrogateType> TypeMap;
+  typedef DenseIndexMap<InterrogateType> TypeMap;
   TypeMap _type_map;
-  typedef std::map<FunctionIndex, InterrogateFunction *> FunctionMap;
+  typedef DenseIndexMap<InterrogateFunction *> FunctionMap;
   FunctionMap _function_map;
-  typedef std::map<FunctionWrapperIndex, InterrogateFunctionWrapper> FunctionWrapperMap;
+  typedef DenseIndexMap<InterrogateFunctionWrapper> FunctionWrapperMap;
   FunctionWrapperMap _wrapper_map;
 
-  typedef std::map<ManifestIndex, InterrogateManifest> ManifestMap;
+  typedef DenseIndexMap<InterrogateManifest> ManifestMap;
   ManifestMap _manifest_map;
-  typedef std::map<ElementIndex, InterrogateElement> ElementMap;
+  typedef DenseIndexMap<InterrogateElement> ElementMap;
   ElementMap _element_map;
 
-  typedef std::map<MakeSeqIndex, InterrogateMakeSeq> MakeSeqMap;
+  typedef DenseIndexMap<InterrogateMakeSeq> MakeSeqMap;
   MakeSeqMap _make_seq_map;
 
   typedef std::vector<TypeIndex> GlobalTypes;
@@ -152,6 +195,33 @@ private:
   typedef std::vector<ElementIndex> GlobalElements;
   GlobalElements _global_elements;
 
+  // In lazy loading mode, the binary database files stay mapped, and the
+  // types, functions and wrappers in them are only decoded the first time
+  // they are asked for.  Until then, they are listed here instead of in the
+  // maps above.
+  // Each module is freed, and its file unmapped, once all of its records
+  // have been decoded.
+  class LazyModule {
+  public:
+    IDFBinaryFile *_file;
+    InterrogateModuleDef *_def;
+    IndexRemapper *_remap;
+    int _num_records;
+  };
+  typedef std::vector<LazyModule *> LazyModules;
+  LazyModules _lazy_modules;
+
+  class LazyRecord {
+  public:
+    LazyModule *_module;
+    int _n;
+  };
+  typedef DenseIndexMap<LazyRecord> LazyRecords;
+  LazyRecords _lazy_types;
+  LazyRecords _lazy_functions;
+  LazyRecords _lazy_wrappers;
+  bool _lazy_loading;
+
   // This data is compiled in directly to the shared libraries that we link
   // with.
   typedef std::vector<InterrogateModuleDef *> Modules;
@@ -173,10 +243,31 @@ private:
     LT_manifest_name       = 0x008,
     LT_element_name        = 0x010,
     LT_element_scoped_name = 0x020,
+
+    LT_type_all            = 0x007,
+    LT_element_all         = 0x030,
+  };
+
+  // Each lookup table is built the first time it is needed, and from then on
+  // it is kept up to date as components are added, updated and removed.
+  class Lookup {
+  public:
+    void add(const std::string &name, int index);
+    void remove(int index);
+    int find(const std::string &name) const;
+    void clear();
+
+  private:
+    typedef std::unordered_multimap<std::string, int> Names;
+    Names _names;
+
+    // The name under which each index is currently listed, pointing to the
+    // key stored in _names.
+    typedef DenseIndexMap<const std::string *> Keys;
+    Keys _keys;
   };
 
   int _lookups_fresh;
-  typedef std::map<std::string, int> Lookup;
   Lookup _types_by_name;
   Lookup _types_by_scoped_name;
   Lookup _types_by_true_name;
@@ -184,6 +275,19 @@ private:
   Lookup _elements_by_name;
   Lookup _elements_by_scoped_name;
 
+  // The components that have been handed out by update_*() since the lookup
+  // tables were last brought up to date.  Their names may have changed since.
+  // Each is listed once, however often it has been handed out.
+  typedef DenseIndexMap<bool> Updated;
+  Updated _updated_types;
+  Updated _updated_manifests;
+  Updated _updated_elements;
+
+  void refresh_type_lookups(TypeIndex type);
+  void refresh_manifest_lookups(ManifestIndex manifest);
+  void refresh_element_lookups(ElementIndex element);
+  void refresh_lookups();
+
   void freshen_types_by_name();
   void freshen_types_by_scoped_name();
   void freshen_types_by_true_name();
@@ -196,8 +300,6 @@ private:
              void (InterrogateDatabase::*freshen)());
 
   static InterrogateDatabase *_global_ptr;
-  static int _file_major_version;
-  static int _file_minor_version;
   static int _current_major_version;
   static int _current_minor_version;
 };
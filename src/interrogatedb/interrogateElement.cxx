@@ -177,6 +177,46 @@ input(std::istream &in) {
   idf_input_string(in, _comment);
 }
 
+/**
+ * Formats the InterrogateElement data for output to a binary data file.
+ */
+void InterrogateElement::
+output_binary(IDFBinaryWriter &out) const {
+  InterrogateComponent::output_binary(out);
+  out.add_int(_flags);
+  out.add_int(_type);
+  out.add_int(_getter);
+  out.add_int(_setter);
+  out.add_int(_has_function);
+  out.add_int(_clear_function);
+  out.add_int(_del_function);
+  out.add_int(_length_function);
+  out.add_int(_insert_function);
+  out.add_int(_getkey_function);
+  out.add_string(_scoped_name);
+  out.add_string(_comment);
+}
+
+/**
+ * Reads the binary data file as previously formatted by output_binary().
+ */
+void InterrogateElement::
+input_binary(IDFBinaryReader &in) {
+  InterrogateComponent::input_binary(in);
+  _flags = in.get_int();
+  _type = in.get_int();
+  _getter = in.get_int();
+  _setter = in.get_int();
+  _has_function = in.get_int();
+  _clear_function = in.get_int();
+  _del_function = in.get_int();
+  _length_function = in.get_int();
+  _insert_function = in.get_int();
+  _getkey_function = in.get_int();
+  in.get_string(_scoped_name);
+  in.get_string(_comment);
+}
+
 /**
  * Remaps all internal index numbers according to the indicated map.  This
  * called from InterrogateDatabase::remap_indices().
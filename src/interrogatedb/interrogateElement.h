@@ -61,6 +61,8 @@ public:
   void write(std::ostream &out, int indent_level = 0) const;
   void output(std::ostream &out) const;
   void input(std::istream &in);
+  void output_binary(IDFBinaryWriter &out) const;
+  void input_binary(IDFBinaryReader &in);
 
   void remap_indices(const IndexRemapper &remap);
 
@@ -185,6 +185,36 @@ input(std::istream &in) {
   idf_input_string(in, _prototype);
 }
 
+/**
+ * Formats the InterrogateFunction data for output to a binary data file.
+ */
+void InterrogateFunction::
+output_binary(IDFBinaryWriter &out) const {
+  InterrogateComponent::output_binary(out);
+  out.add_int(_flags);
+  out.add_int(_class);
+  out.add_string(_scoped_name);
+  out.add_vector(_c_wrappers);
+  out.add_vector(_python_wrappers);
+  out.add_string(_comment);
+  out.add_string(_prototype);
+}
+
+/**
+ * Reads the binary data file as previously formatted by output_binary().
+ */
+void InterrogateFunction::
+input_binary(IDFBinaryReader &in) {
+  InterrogateComponent::input_binary(in);
+  _flags = in.get_int();
+  _class = in.get_int();
+  in.get_string(_scoped_name);
+  in.get_vector(_c_wrappers);
+  in.get_vector(_python_wrappers);
+  in.get_string(_comment);
+  in.get_string(_prototype);
+}
+
 /**
  * Remaps all internal index numbers according to the indicated map.  This
  * called from InterrogateDatabase::remap_indices().
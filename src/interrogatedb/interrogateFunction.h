@@ -63,6 +63,8 @@ public:
 
   void output(std::ostream &out) const;
   void input(std::istream &in);
+  void output_binary(IDFBinaryWriter &out) const;
+  void input_binary(IDFBinaryReader &in);
 
   void remap_indices(const IndexRemapper &remap);
 
@@ -40,6 +40,26 @@ input(istream &in) {
   in >> _parameter_flags >> _type;
 }
 
+/**
+ *
+ */
+void InterrogateFunctionWrapper::Parameter::
+output_binary(IDFBinaryWriter &out) const {
+  out.add_string(_name);
+  out.add_int(_parameter_flags);
+  out.add_int(_type);
+}
+
+/**
+ *
+ */
+void InterrogateFunctionWrapper::Parameter::
+input_binary(IDFBinaryReader &in) {
+  in.get_string(_name);
+  _parameter_flags = in.get_int();
+  _type = in.get_int();
+}
+
 /**
  * Formats the function wrapper in a human-readable manner.
  */
@@ -156,6 +176,49 @@ input(istream &in) {
   idf_input_vector(in, _parameters);
 }
 
+/**
+ * Formats the InterrogateFunctionWrapper data for output to a binary data
+ * file.
+ */
+void InterrogateFunctionWrapper::
+output_binary(IDFBinaryWriter &out) const {
+  InterrogateComponent::output_binary(out);
+  out.add_int(_flags);
+  out.add_int(_function);
+  out.add_int(_return_type);
+  out.add_int(_return_value_destructor);
+  out.add_string(_unique_name);
+  out.add_string(_comment);
+
+  out.add_int((int)_parameters.size());
+  Parameters::const_iterator pi;
+  for (pi = _parameters.begin(); pi != _parameters.end(); ++pi) {
+    (*pi).output_binary(out);
+  }
+}
+
+/**
+ * Reads the binary data file as previously formatted by output_binary().
+ */
+void InterrogateFunctionWrapper::
+input_binary(IDFBinaryReader &in) {
+  InterrogateComponent::input_binary(in);
+  _flags = in.get_int();
+  _function = in.get_int();
+  _return_type = in.get_int();
+  _return_value_destructor = in.get_int();
+  in.get_string(_unique_name);
+  in.get_string(_comment);
+
+  int num_parameters = in.get_int();
+  _parameters.clear();
+  for (int i = 0; i < num_parameters && !in.is_error(); ++i) {
+    Parameter param;
+    param.input_binary(in);
+    _parameters.push_back(param);
+  }
+}
+
 /**
  * Remaps all internal index numbers according to the indicated map.  This
  * called from InterrogateDatabase::remap_indices().
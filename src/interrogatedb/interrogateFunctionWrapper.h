@@ -59,6 +59,8 @@ public:
   void write(std::ostream &out, int indent_level = 0, const char *tag = "wrapper") const;
   void output(std::ostream &out) const;
   void input(std::istream &in);
+  void output_binary(IDFBinaryWriter &out) const;
+  void input_binary(IDFBinaryReader &in);
 
   void remap_indices(const IndexRemapper &remap);
 
@@ -94,6 +96,8 @@ public:
   public:
     void output(std::ostream &out) const;
     void input(std::istream &in);
+    void output_binary(IDFBinaryWriter &out) const;
+    void input_binary(IDFBinaryReader &in);
 
     int _parameter_flags;
     TypeIndex _type;
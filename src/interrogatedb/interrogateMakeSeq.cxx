@@ -87,6 +87,30 @@ input(std::istream &in) {
   idf_input_string(in, _comment);
 }
 
+/**
+ * Formats the InterrogateMakeSeq data for output to a binary data file.
+ */
+void InterrogateMakeSeq::
+output_binary(IDFBinaryWriter &out) const {
+  InterrogateComponent::output_binary(out);
+  out.add_int(_length_getter);
+  out.add_int(_element_getter);
+  out.add_string(_scoped_name);
+  out.add_string(_comment);
+}
+
+/**
+ * Reads the binary data file as previously formatted by output_binary().
+ */
+void InterrogateMakeSeq::
+input_binary(IDFBinaryReader &in) {
+  InterrogateComponent::input_binary(in);
+  _length_getter = in.get_int();
+  _element_getter = in.get_int();
+  in.get_string(_scoped_name);
+  in.get_string(_comment);
+}
+
 /**
  * Remaps all internal index numbers according to the indicated map.  This
  * called from InterrogateDatabase::remap_indices().
@@ -70,6 +70,32 @@ input(std::istream &in) {
   idf_input_string(in, _definition);
 }
 
+/**
+ * Formats the InterrogateManifest data for output to a binary data file.
+ */
+void InterrogateManifest::
+output_binary(IDFBinaryWriter &out) const {
+  InterrogateComponent::output_binary(out);
+  out.add_int(_flags);
+  out.add_int(_int_value);
+  out.add_int(_type);
+  out.add_int(_getter);
+  out.add_string(_definition);
+}
+
+/**
+ * Reads the binary data file as previously formatted by output_binary().
+ */
+void InterrogateManifest::
+input_binary(IDFBinaryReader &in) {
+  InterrogateComponent::input_binary(in);
+  _flags = in.get_int();
+  _int_value = in.get_int();
+  _type = in.get_int();
+  _getter = in.get_int();
+  in.get_string(_definition);
+}
+
 /**
  * Remaps all internal index numbers according to the indicated map.  This
  * called from InterrogateDatabase::remap_indices().
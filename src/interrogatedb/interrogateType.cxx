@@ -64,6 +64,28 @@ input(istream &in) {
   in >> _flags >> _base >> _upcast >> _downcast;
 }
 
+/**
+ *
+ */
+void InterrogateType::Derivation::
+output_binary(IDFBinaryWriter &out) const {
+  out.add_int(_flags);
+  out.add_int(_base);
+  out.add_int(_upcast);
+  out.add_int(_downcast);
+}
+
+/**
+ *
+ */
+void InterrogateType::Derivation::
+input_binary(IDFBinaryReader &in) {
+  _flags = in.get_int();
+  _base = in.get_int();
+  _upcast = in.get_int();
+  _downcast = in.get_int();
+}
+
 /**
  *
  */
@@ -86,6 +108,28 @@ input(istream &in) {
   in >> _value;
 }
 
+/**
+ *
+ */
+void InterrogateType::EnumValue::
+output_binary(IDFBinaryWriter &out) const {
+  out.add_string(_name);
+  out.add_string(_scoped_name);
+  out.add_string(_comment);
+  out.add_int(_value);
+}
+
+/**
+ *
+ */
+void InterrogateType::EnumValue::
+input_binary(IDFBinaryReader &in) {
+  in.get_string(_name);
+  in.get_string(_scoped_name);
+  in.get_string(_comment);
+  _value = in.get_int();
+}
+
 /**
  *
  */
@@ -436,6 +480,88 @@ input(istream &in) {
   idf_input_string(in, _comment);
 }
 
+/**
+ * Formats the InterrogateType data for output to a binary data file.  Unlike
+ * the text format, this always includes the array size, so that every record
+ * has the same layout.
+ */
+void InterrogateType::
+output_binary(IDFBinaryWriter &out) const {
+  InterrogateComponent::output_binary(out);
+
+  out.add_int(_flags);
+  out.add_string(_scoped_name);
+  out.add_string(_true_name);
+  out.add_int(_outer_class);
+  out.add_int((int)_atomic_token);
+  out.add_int(_wrapped_type);
+  out.add_int(_array_size);
+
+  out.add_vector(_constructors);
+  out.add_int(_destructor);
+  out.add_vector(_elements);
+  out.add_vector(_methods);
+  out.add_vector(_make_seqs);
+  out.add_vector(_casts);
+
+  out.add_int((int)_derivations.size());
+  Derivations::const_iterator di;
+  for (di = _derivations.begin(); di != _derivations.end(); ++di) {
+    (*di).output_binary(out);
+  }
+
+  out.add_int((int)_enum_values.size());
+  EnumValues::const_iterator ei;
+  for (ei = _enum_values.begin(); ei != _enum_values.end(); ++ei) {
+    (*ei).output_binary(out);
+  }
+
+  out.add_vector(_nested_types);
+  out.add_string(_comment);
+}
+
+/**
+ * Reads the binary data file as previously formatted by output_binary().
+ */
+void InterrogateType::
+input_binary(IDFBinaryReader &in) {
+  InterrogateComponent::input_binary(in);
+
+  _flags = in.get_int();
+  in.get_string(_scoped_name);
+  in.get_string(_true_name);
+  _outer_class = in.get_int();
+  _atomic_token = (AtomicToken)in.get_int();
+  _wrapped_type = in.get_int();
+  _array_size = in.get_int();
+
+  in.get_vector(_constructors);
+  _destructor = in.get_int();
+  in.get_vector(_elements);
+  in.get_vector(_methods);
+  in.get_vector(_make_seqs);
+  in.get_vector(_casts);
+
+  int num_derivations = in.get_int();
+  _derivations.clear();
+  for (int i = 0; i < num_derivations && !in.is_error(); ++i) {
+    Derivation d;
+    d.input_binary(in);
+    _derivations.push_back(d);
+  }
+
+  int num_enum_values = in.get_int();
+  _enum_values.clear();
+  for (int i = 0; i < num_enum_values && !in.is_error(); ++i) {
+    EnumValue ev;
+    ev.input_binary(in);
+    _enum_values.push_back(ev);
+  }
+
+  in.get_vector(_nested_types);
+  in.get_string(_comment);
+}
+
 /**
  * Remaps all internal index numbers according to the indicated map.  This
  * called from InterrogateDatabase::remap_indices().
@@ -112,6 +112,8 @@ public:
   void merge_with(const InterrogateType &other);
   void output(std::ostream &out) const;
   void input(std::istream &in);
+  void output_binary(IDFBinaryWriter &out) const;
+  void input_binary(IDFBinaryReader &in);
 
   void write(std::ostream &out, int indent_level = 0) const;
 
@@ -184,6 +186,8 @@ public:
   public:
     void output(std::ostream &out) const;
     void input(std::istream &in);
+    void output_binary(IDFBinaryWriter &out) const;
+    void input_binary(IDFBinaryReader &in);
 
     int _flags;
     TypeIndex _base;
@@ -201,6 +205,8 @@ public:
   public:
     void output(std::ostream &out) const;
     void input(std::istream &in);
+    void output_binary(IDFBinaryWriter &out) const;
+    void input_binary(IDFBinaryReader &in);
 
     std::string _name;
     std::string _scoped_name;
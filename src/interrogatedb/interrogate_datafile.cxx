@@ -13,12 +13,43 @@
 
 #include "interrogate_datafile.h"
 
+#include <algorithm>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using std::istream;
 using std::ostream;
 using std::string;
 
+// The first bytes of a binary database file.  The first byte is chosen so
+// that it can never begin a text database file, which starts with a number.
+static const char binary_magic[4] = { '\x89', 'I', 'D', 'B' };
+
+// The size of the fixed header of a binary database file, and the offset of
+// the index table descriptors within it.
+static const size_t binary_header_size = 96;
+static const size_t binary_tables_offset = 48;
+
+// The size of one entry of an index table: the index, the file offset of the
+// record, the IDFBinaryFlags and references to the component's name, scoped
+// name and true name.
+static const size_t binary_entry_size = 24;
+
+const unsigned int IDFBinaryFile::_binary_version = 2;
+
 
 /**
  * Writes the indicated string to the output file.  Uses the given whitespace
@@ -98,3 +129,479 @@ idf_input_string(istream &in, const char *&str) {
 
   str = readstr;
 }
+
+/**
+ *
+ */
+IDFBinaryWriter::
+IDFBinaryWriter() {
+  // Reserve the first pool entry for the empty string, so that a zero
+  // reference (as well as a null pointer) reads back as an empty string.
+  get_string_ref(string());
+}
+
+/**
+ * Starts a new record for the component with the indicated index, and adds
+ * it to the given index table along with the component's flags and names, so
+ * that a reader can find the component without decoding the record.  The
+ * component's fields should be added immediately afterwards.
+ */
+void IDFBinaryWriter::
+begin_record(IDFBinaryTable table, int index, int flags, const string &name,
+             const string &scoped_name, const string &true_name) {
+  IndexEntry entry;
+  entry._index = index;
+  entry._offset = (unsigned int)_data.size();
+  entry._flags = flags;
+  entry._names[BN_name] = get_string_ref(name);
+  entry._names[BN_scoped_name] = get_string_ref(scoped_name);
+  entry._names[BN_true_name] = get_string_ref(true_name);
+  _tables[table].push_back(entry);
+}
+
+/**
+ * Writes the indicated string to the binary record being built.  A null
+ * pointer is written as the empty string.
+ */
+void IDFBinaryWriter::
+add_string(const char *str) {
+  if (str == nullptr) {
+    add_word(_data, 0);
+  } else {
+    add_word(_data, get_string_ref(str));
+  }
+}
+
+/**
+ * Writes the complete binary database file, consisting of the header, the
+ * index tables, the records that have been added and the string pool.
+ */
+void IDFBinaryWriter::
+write(ostream &out, int file_identifier, int major_version, int minor_version,
+      const char *library_name, const char *library_hash_name,
+      const char *module_name) {
+  unsigned int library_name_ref = get_string_ref(library_name != nullptr ? library_name : "");
+  unsigned int library_hash_name_ref = get_string_ref(library_hash_name != nullptr ? library_hash_name : "");
+  unsigned int module_name_ref = get_string_ref(module_name != nullptr ? module_name : "");
+
+  size_t tables_size = 0;
+  for (int t = 0; t < BT_num_tables; ++t) {
+    tables_size += _tables[t].size() * binary_entry_size;
+  }
+  size_t data_offset = binary_header_size + tables_size;
+  size_t pool_offset = data_offset + _data.size();
+
+  string header(binary_magic, sizeof(binary_magic));
+  add_word(header, IDFBinaryFile::_binary_version);
+  add_word(header, (unsigned int)file_identifier);
+  add_word(header, (unsigned int)major_version);
+  add_word(header, (unsigned int)minor_version);
+  add_word(header, library_name_ref);
+  add_word(header, library_hash_name_ref);
+  add_word(header, module_name_ref);
+  add_word(header, (unsigned int)data_offset);
+  add_word(header, (unsigned int)_data.size());
+  add_word(header, (unsigned int)pool_offset);
+  add_word(header, (unsigned int)_pool.size());
+
+  string tables;
+  size_t table_offset = binary_header_size;
+  for (int t = 0; t < BT_num_tables; ++t) {
+    add_word(header, (unsigned int)_tables[t].size());
+    add_word(header, (unsigned int)table_offset);
+    table_offset += _tables[t].size() * binary_entry_size;
+
+    Table::const_iterator ti;
+    for (ti = _tables[t].begin(); ti != _tables[t].end(); ++ti) {
+      add_word(tables, (unsigned int)(*ti)._index);
+      add_word(tables, (unsigned int)(data_offset + (*ti)._offset));
+      add_word(tables, (unsigned int)(*ti)._flags);
+      add_word(tables, (*ti)._names[BN_name]);
+      add_word(tables, (*ti)._names[BN_scoped_name]);
+      add_word(tables, (*ti)._names[BN_true_name]);
+    }
+  }
+  assert(header.size() == binary_header_size);
+
+  out.write(header.data(), header.size());
+  out.write(tables.data(), tables.size());
+  out.write(_data.data(), _data.size());
+  out.write(_pool.data(), _pool.size());
+}
+
+/**
+ * Appends the indicated value to the given buffer as a little-endian word.
+ */
+void IDFBinaryWriter::
+add_word(string &into, unsigned int value) {
+  into += (char)(value & 0xff);
+  into += (char)((value >> 8) & 0xff);
+  into += (char)((value >> 16) & 0xff);
+  into += (char)((value >> 24) & 0xff);
+}
+
+/**
+ * Returns the offset of the indicated string within the string pool, adding
+ * it to the pool first if it is not already there.  Each pool entry is the
+ * length of the string followed by its characters and a terminating null.
+ */
+unsigned int IDFBinaryWriter::
+get_string_ref(const string &str) {
+  StringRefs::const_iterator si = _string_refs.find(str);
+  if (si != _string_refs.end()) {
+    return (*si).second;
+  }
+
+  unsigned int ref = (unsigned int)_pool.size();
+  add_word(_pool, (unsigned int)str.size());
+  _pool += str;
+  _pool += '\0';
+  _string_refs[str] = ref;
+  return ref;
+}
+
+/**
+ * Reads the next word from the record, as written by
+ * IDFBinaryWriter::add_int().
+ */
+int IDFBinaryReader::
+get_int() {
+  unsigned int value;
+  if (_error || _offset > _end || _end - _offset < 4 ||
+      !_file->get_word(_offset, value)) {
+    _error = true;
+    return 0;
+  }
+  _offset += 4;
+  return (int)value;
+}
+
+/**
+ * Reads the next string from the record, as written by
+ * IDFBinaryWriter::add_string().
+ */
+void IDFBinaryReader::
+get_string(string &str) {
+  const char *data;
+  size_t length;
+  unsigned int ref = (unsigned int)get_int();
+  if (_error || !_file->get_string(ref, data, length)) {
+    _error = true;
+    return;
+  }
+  str.assign(data, length);
+}
+
+/**
+ * Reads the next string from the record into a newly allocated buffer, as
+ * idf_input_string() does.  The string is left unchanged if it is empty.
+ */
+void IDFBinaryReader::
+get_string(const char *&str) {
+  const char *data;
+  size_t length;
+  unsigned int ref = (unsigned int)get_int();
+  if (_error || !_file->get_string(ref, data, length)) {
+    _error = true;
+    return;
+  }
+
+  if (length == 0) {
+    return;
+  }
+
+  char *readstr = new char[length + 1];
+  memcpy(readstr, data, length + 1);
+  str = readstr;
+}
+
+/**
+ *
+ */
+IDFBinaryFile::
+IDFBinaryFile() :
+  _data(nullptr),
+  _size(0),
+#ifdef _WIN32
+  _file_handle(nullptr),
+  _mapping_handle(nullptr),
+#endif
+  _is_mapped(false)
+{
+}
+
+/**
+ *
+ */
+IDFBinaryFile::
+~IDFBinaryFile() {
+  close();
+}
+
+/**
+ * Returns true if the indicated stream, positioned at the start of a
+ * database file, contains a file in the binary format.  The stream position
+ * is left unchanged.
+ */
+bool IDFBinaryFile::
+is_binary(istream &in) {
+  char magic[sizeof(binary_magic)];
+  std::streampos pos = in.tellg();
+  in.read(magic, sizeof(magic));
+  bool result = !in.fail() && memcmp(magic, binary_magic, sizeof(magic)) == 0;
+  in.clear();
+  in.seekg(pos);
+  return result;
+}
+
+/**
+ * Maps the indicated binary database file into memory and validates its
+ * header and index tables.  Returns true on success, false if the file could
+ * not be read or is not a valid binary database file.
+ */
+bool IDFBinaryFile::
+open(const Filename &filename) {
+  close();
+
+#ifdef _WIN32
+  std::wstring os_specific = filename.to_os_specific_w();
+  HANDLE file = CreateFileW(os_specific.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+      HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping != nullptr) {
+        void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view != nullptr) {
+          _data = (const char *)view;
+          _size = (size_t)size.QuadPart;
+          _file_handle = file;
+          _mapping_handle = mapping;
+          _is_mapped = true;
+          return validate();
+        }
+        CloseHandle(mapping);
+      }
+    }
+    CloseHandle(file);
+  }
+#else
+  string os_specific = filename.to_os_specific();
+  int fd = ::open(os_specific.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (view != MAP_FAILED) {
+        ::close(fd);
+        _data = (const char *)view;
+        _size = (size_t)st.st_size;
+        _is_mapped = true;
+        return validate();
+      }
+    }
+    ::close(fd);
+  }
+#endif
+
+  // Mapping the file didn't work, so read it into memory instead.
+  Filename binary_filename = filename;
+  binary_filename.set_binary();
+  std::ifstream in;
+  if (!binary_filename.open_read(in)) {
+    return false;
+  }
+  _buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  _data = _buffer.data();
+  _size = _buffer.size();
+  return validate();
+}
+
+/**
+ * Unmaps the file, if it is open.  Any records decoded from it remain valid,
+ * since they do not point into the file.
+ */
+void IDFBinaryFile::
+close() {
+  if (_is_mapped) {
+#ifdef _WIN32
+    UnmapViewOfFile((LPCVOID)_data);
+    CloseHandle((HANDLE)_mapping_handle);
+    CloseHandle((HANDLE)_file_handle);
+    _mapping_handle = nullptr;
+    _file_handle = nullptr;
+#else
+    munmap((void *)_data, _size);
+#endif
+    _is_mapped = false;
+  }
+  _buffer.clear();
+  _data = nullptr;
+  _size = 0;
+}
+
+/**
+ * Returns a reader positioned at the module definition strings stored in the
+ * header: the library name, the library hash name and the module name.
+ */
+IDFBinaryReader IDFBinaryFile::
+get_header_reader() const {
+  return IDFBinaryReader(this, 20, binary_tables_offset);
+}
+
+/**
+ * Returns the index number of the nth record in the indicated table.
+ */
+int IDFBinaryFile::
+get_record_index(IDFBinaryTable table, int n) const {
+  assert(n >= 0 && n < _num_records[table]);
+  unsigned int value = 0;
+  get_word(_table_offsets[table] + n * binary_entry_size, value);
+  return (int)value;
+}
+
+/**
+ * Returns a reader positioned at the start of the nth record in the
+ * indicated table.
+ */
+IDFBinaryReader IDFBinaryFile::
+get_record(IDFBinaryTable table, int n) const {
+  assert(n >= 0 && n < _num_records[table]);
+  unsigned int offset = 0;
+  get_word(_table_offsets[table] + n * binary_entry_size + 4, offset);
+  return IDFBinaryReader(this, offset, _data_offset + _data_size);
+}
+
+/**
+ * Returns the IDFBinaryFlags stored in the index table for the nth record of
+ * the given table.
+ */
+int IDFBinaryFile::
+get_record_flags(IDFBinaryTable table, int n) const {
+  assert(n >= 0 && n < _num_records[table]);
+  unsigned int value = 0;
+  get_word(_table_offsets[table] + n * binary_entry_size + 8, value);
+  return (int)value;
+}
+
+/**
+ * Returns the indicated name stored in the index table for the nth record of
+ * the given table.  The returned pointer points into the file.  Returns the
+ * empty string if the name is not valid.
+ */
+const char *IDFBinaryFile::
+get_record_name(IDFBinaryTable table, int n, IDFBinaryName which) const {
+  assert(n >= 0 && n < _num_records[table]);
+  unsigned int ref = 0;
+  const char *str;
+  size_t length;
+  if (!get_word(_table_offsets[table] + n * binary_entry_size + 12 + which * 4, ref) ||
+      !get_string(ref, str, length)) {
+    return "";
+  }
+  return str;
+}
+
+/**
+ * Reads the little-endian word at the indicated offset of the file.  Returns
+ * false if this lies beyond the end of the file.
+ */
+bool IDFBinaryFile::
+get_word(size_t offset, unsigned int &value) const {
+  if (offset > _size || _size - offset < 4) {
+    return false;
+  }
+  const unsigned char *p = (const unsigned char *)_data + offset;
+  value = (unsigned int)p[0] | ((unsigned int)p[1] << 8) |
+    ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+  return true;
+}
+
+/**
+ * Looks up the string with the indicated reference in the string pool.  The
+ * returned pointer points into the file and is null-terminated.  Returns
+ * false if the reference is not valid.
+ */
+bool IDFBinaryFile::
+get_string(unsigned int ref, const char *&str, size_t &length) const {
+  unsigned int value;
+  if (ref > _pool_size || _pool_size - ref < 4 ||
+      !get_word(_pool_offset + ref, value)) {
+    return false;
+  }
+  if (_pool_size - ref - 4 <= value) {
+    // There is no room for the string and its terminating null.
+    return false;
+  }
+  str = _data + _pool_offset + ref + 4;
+  length = value;
+  return true;
+}
+
+/**
+ * Reads the header of the file and checks that the file is consistent with
+ * it.  Returns true if the file is valid.
+ */
+bool IDFBinaryFile::
+validate() {
+  if (_size < binary_header_size ||
+      memcmp(_data, binary_magic, sizeof(binary_magic)) != 0) {
+    return false;
+  }
+
+  unsigned int words[11];
+  for (int i = 0; i < 11; ++i) {
+    get_word(4 + i * 4, words[i]);
+  }
+  if (words[0] != _binary_version) {
+    return false;
+  }
+  _file_identifier = (int)words[1];
+  _major_version = (int)words[2];
+  _minor_version = (int)words[3];
+  _data_offset = words[7];
+  _data_size = words[8];
+  _pool_offset = words[9];
+  _pool_size = words[10];
+
+  if (_data_offset > _size || _size - _data_offset < _data_size ||
+      _pool_offset > _size || _size - _pool_offset < _pool_size) {
+    return false;
+  }
+
+  for (int t = 0; t < BT_num_tables; ++t) {
+    unsigned int count, offset;
+    get_word(binary_tables_offset + t * 8, count);
+    get_word(binary_tables_offset + t * 8 + 4, offset);
+    if (offset > _size || (_size - offset) / binary_entry_size < count) {
+      return false;
+    }
+    _num_records[t] = (int)count;
+    _table_offsets[t] = offset;
+  }
+
+  // The indices within each table are written in increasing order, and no
+  // index may be shared between two records, or the records would collide
+  // when they are added to the database.
+  std::vector<unsigned int> indices;
+  for (int t = 0; t < BT_num_tables; ++t) {
+    unsigned int prev = 0;
+    for (int n = 0; n < _num_records[t]; ++n) {
+      unsigned int index = 0;
+      get_word(_table_offsets[t] + n * binary_entry_size, index);
+      if (index <= prev || index > 0x7fffffff) {
+        return false;
+      }
+      indices.push_back(index);
+      prev = index;
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+  if (std::adjacent_find(indices.begin(), indices.end()) != indices.end()) {
+    return false;
+  }
+
+  return true;
+}
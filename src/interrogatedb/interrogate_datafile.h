@@ -17,6 +17,10 @@
 // This file defines some convenience functions for reading and writing the
 // interrogate database files.
 
+#include "dtoolbase.h"
+#include "filename.h"
+
+#include <map>
 #include <vector>
 #include <istream>
 #include <ostream>
@@ -33,6 +37,164 @@ void idf_output_vector(std::ostream &out, const std::vector<Element> &vec);
 template<class Element>
 void idf_input_vector(std::istream &in, std::vector<Element> &vec);
 
+class IDFBinaryFile;
+
+// The binary database format consists of a fixed-size header, followed by
+// one index table per kind of component, the encoded component records and
+// finally a pool of the strings the records refer to.  All values are stored
+// as 32-bit little-endian words, and strings are stored as offsets into the
+// string pool, so a record can be decoded straight out of a mapped file.
+enum IDFBinaryTable {
+  BT_function,
+  BT_wrapper,
+  BT_type,
+  BT_manifest,
+  BT_element,
+  BT_make_seq,
+  BT_num_tables,
+};
+
+// The names that are stored with each entry of an index table, so that a
+// component can be looked up by name without decoding its record.
+enum IDFBinaryName {
+  BN_name,
+  BN_scoped_name,
+  BN_true_name,
+};
+
+// The flags that are stored with each entry of an index table.
+enum IDFBinaryFlags {
+  BF_global = 0x0001,
+};
+
+/**
+ * Accumulates the component records and the string pool of a binary database
+ * file, and writes out the finished file.
+ */
+class IDFBinaryWriter {
+public:
+  IDFBinaryWriter();
+
+  void begin_record(IDFBinaryTable table, int index, int flags,
+                    const std::string &name,
+                    const std::string &scoped_name = std::string(),
+                    const std::string &true_name = std::string());
+
+  INLINE void add_int(int value);
+  INLINE void add_string(const std::string &str);
+  void add_string(const char *str);
+
+  template<class Element>
+  void add_vector(const std::vector<Element> &vec);
+
+  void write(std::ostream &out, int file_identifier,
+             int major_version, int minor_version,
+             const char *library_name, const char *library_hash_name,
+             const char *module_name);
+
+private:
+  void add_word(std::string &into, unsigned int value);
+  unsigned int get_string_ref(const std::string &str);
+
+  class IndexEntry {
+  public:
+    int _index;
+    unsigned int _offset;
+    int _flags;
+    unsigned int _names[3];
+  };
+  typedef std::vector<IndexEntry> Table;
+  Table _tables[BT_num_tables];
+
+  std::string _data;
+  std::string _pool;
+  typedef std::map<std::string, unsigned int> StringRefs;
+  StringRefs _string_refs;
+};
+
+/**
+ * Decodes the words of one record in a binary database file.  Reading past
+ * the end of the file sets an error flag and returns zero, rather than
+ * reading out of bounds.
+ */
+class IDFBinaryReader {
+public:
+  INLINE IDFBinaryReader(const IDFBinaryFile *file, size_t offset,
+                         size_t end);
+
+  INLINE bool is_error() const;
+
+  int get_int();
+  void get_string(std::string &str);
+  void get_string(const char *&str);
+
+  template<class Element>
+  void get_vector(std::vector<Element> &vec);
+
+private:
+  const IDFBinaryFile *_file;
+  size_t _offset;
+  size_t _end;
+  bool _error;
+};
+
+/**
+ * A database file written in the binary format, mapped into memory (or read
+ * into a buffer, where mapping is not possible).  The header and index tables
+ * are validated on open, after which records may be decoded in any order.
+ */
+class IDFBinaryFile {
+public:
+  IDFBinaryFile();
+  ~IDFBinaryFile();
+
+  static bool is_binary(std::istream &in);
+
+  bool open(const Filename &filename);
+  void close();
+
+  INLINE int get_file_identifier() const;
+  INLINE int get_major_version() const;
+  INLINE int get_minor_version() const;
+
+  IDFBinaryReader get_header_reader() const;
+
+  INLINE int get_num_records(IDFBinaryTable table) const;
+  int get_record_index(IDFBinaryTable table, int n) const;
+  IDFBinaryReader get_record(IDFBinaryTable table, int n) const;
+  int get_record_flags(IDFBinaryTable table, int n) const;
+  const char *get_record_name(IDFBinaryTable table, int n,
+                              IDFBinaryName which) const;
+
+  bool get_word(size_t offset, unsigned int &value) const;
+  bool get_string(unsigned int ref, const char *&str, size_t &length) const;
+
+  static const unsigned int _binary_version;
+
+private:
+  bool validate();
+
+  const char *_data;
+  size_t _size;
+
+#ifdef _WIN32
+  void *_file_handle;
+  void *_mapping_handle;
+#endif
+  bool _is_mapped;
+  std::string _buffer;
+
+  int _file_identifier;
+  int _major_version;
+  int _minor_version;
+  size_t _pool_offset;
+  size_t _pool_size;
+  size_t _data_offset;
+  size_t _data_size;
+  int _num_records[BT_num_tables];
+  size_t _table_offsets[BT_num_tables];
+};
+
 #include "interrogate_datafile.I"
 
 #endif
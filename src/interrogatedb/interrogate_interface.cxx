@@ -38,6 +38,15 @@ interrogate_add_search_path(const char *pathstring) {
   interrogatedb_path.append_path(pathstring);
 }
 
+// Call this before the database is first queried to load binary database
+// files lazily: only their index tables are read up front, and each type,
+// function and function wrapper is decoded the first time it is asked for.
+void
+interrogate_set_lazy_loading(bool lazy) {
+  // cerr << "interrogate_set_lazy_loading(" << lazy << ")\n";
+  InterrogateDatabase::get_ptr()->set_lazy_loading(lazy);
+}
+
 bool interrogate_error_flag() {
   // cerr << "interrogate_error_flag\n";
   return InterrogateDatabase::get_ptr()->get_error_flag();
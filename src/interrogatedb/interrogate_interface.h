@@ -91,6 +91,7 @@ enum AtomicToken {
 
 EXPCL_INTERROGATEDB void interrogate_add_search_directory(const char *dirname);
 EXPCL_INTERROGATEDB void interrogate_add_search_path(const char *pathstring);
+EXPCL_INTERROGATEDB void interrogate_set_lazy_loading(bool lazy);
 EXPCL_INTERROGATEDB bool interrogate_error_flag();
 
 // Manifest Symbols
@@ -2,6 +2,7 @@ def interrogate_request_database(database_filename: str) -> None: ...
 def interrogate_request_module(def_: int) -> None: ...
 def interrogate_add_search_directory(dirname: str) -> None: ...
 def interrogate_add_search_path(pathstring: str) -> None: ...
+def interrogate_set_lazy_loading(lazy: bool) -> None: ...
 def interrogate_error_flag() -> bool: ...
 
 # Manifest Symbols
@@ -31,7 +31,14 @@
 
 #include <Python.h>
 
-#ifndef LINK_ALL_STATIC
+// When the support code lives in the shared interrogate_runtime library
+// rather than being pasted into each module, its symbols must be visible
+// across the library boundary.
+#if defined(BUILDING_INTERROGATE_RUNTIME)
+#  define EXPCL_PYPANDA EXPORT_CLASS
+#elif defined(USE_INTERROGATE_RUNTIME)
+#  define EXPCL_PYPANDA IMPORT_CLASS
+#elif !defined(LINK_ALL_STATIC)
 #  define EXPCL_PYPANDA
 #elif defined(__GNUC__)
 #  define EXPCL_PYPANDA __attribute__((weak))
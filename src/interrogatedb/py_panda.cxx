@@ -8,8 +8,49 @@
 
 #ifdef HAVE_PYTHON
 
+#include <unordered_map>
+
 using std::string;
 
+namespace {
+  // Identifies a wrapper in the identity cache: the pointer and type that it
+  // was created for, the index of the TypeHandle of the object's dynamic
+  // type (or 0 if it is not known), and its constness.  The dynamic type is
+  // part of the key so that a wrapper for a deleted object is not returned
+  // for a different kind of object that was later allocated at its address.
+  struct IdentityKey {
+    void *_ptr;
+    Dtool_PyTypedObject *_type;
+    int _type_index;
+    bool _is_const;
+
+    bool operator == (const IdentityKey &other) const {
+      return _ptr == other._ptr && _type == other._type &&
+             _type_index == other._type_index && _is_const == other._is_const;
+    }
+  };
+
+  struct IdentityKeyHash {
+    size_t operator () (const IdentityKey &key) const {
+      size_t hash = std::hash<void *>()(key._ptr);
+      hash ^= std::hash<void *>()(key._type) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      hash ^= std::hash<int>()(key._type_index) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      return hash + key._is_const;
+    }
+  };
+
+  // Maps the C++ objects that are currently wrapped to their wrappers, so
+  // that wrapping the same object again can return the same wrapper.  The
+  // references are weak; a wrapper removes itself when it is deallocated.
+  struct IdentityCache {
+    PY_INT64_T _interp_id;
+    std::unordered_map<IdentityKey, PyObject *, IdentityKeyHash> _wrappers;
+    std::unordered_map<PyObject *, IdentityKey> _keys;
+  };
+}
+
+static IdentityCache *identity_cache = nullptr;
+
 /**
 
  */
@@ -253,6 +294,144 @@ int _Dtool_Raise_BadArgumentsError_Int() {
   return -1;
 }
 
+/**
+ * Returns the interpreter that the calling thread is running in.
+ */
+static PyInterpreterState *
+get_current_interpreter() {
+#if PY_VERSION_HEX >= 0x03090000
+  return PyInterpreterState_Get();
+#else
+  return PyThreadState_GET()->interp;
+#endif
+}
+
+/**
+ * Returns an ID for the interpreter that the calling thread is running in.
+ * Unlike the PyInterpreterState pointer, this is never reused by a later
+ * interpreter.
+ */
+static PY_INT64_T
+get_current_interpreter_id() {
+#if PY_VERSION_HEX >= 0x03070000
+  return PyInterpreterState_GetID(get_current_interpreter());
+#else
+  // Interpreters have no ID before 3.7, but they also share the allocator, so
+  // it is safe for them to share a free list.
+  return 0;
+#endif
+}
+
+/**
+ * Enables the identity cache for the calling interpreter.  While it is
+ * enabled, wrapping a C++ pointer that already has a live wrapper of the same
+ * type and constness returns that wrapper rather than creating a new one, so
+ * that repeated calls to an accessor produce the same object.
+ *
+ * Returns false if the cache is already enabled for another interpreter, or
+ * if this is a free-threaded build, which is not supported.
+ */
+bool Dtool_EnableIdentityCache() {
+#ifdef Py_GIL_DISABLED
+  return false;
+#else
+  PY_INT64_T interp_id = get_current_interpreter_id();
+  if (identity_cache == nullptr) {
+    identity_cache = new IdentityCache;
+    identity_cache->_interp_id = interp_id;
+  }
+  return identity_cache->_interp_id == interp_id;
+#endif
+}
+
+/**
+ * Disables the identity cache, if it was enabled for the calling interpreter.
+ * Existing wrappers are left alone.
+ */
+void Dtool_DisableIdentityCache() {
+  if (identity_cache == nullptr ||
+      identity_cache->_interp_id != get_current_interpreter_id()) {
+    return;
+  }
+
+  for (const auto &item : identity_cache->_keys) {
+    ((Dtool_PyInstDef *)item.first)->_is_cached = false;
+  }
+  delete identity_cache;
+  identity_cache = nullptr;
+}
+
+/**
+ * Removes an instance from the identity cache.  Use Dtool_UncacheInstance()
+ * instead.
+ */
+void _Dtool_UncacheInstance(PyObject *self) {
+  ((Dtool_PyInstDef *)self)->_is_cached = false;
+  nassertv(identity_cache != nullptr);
+
+  auto it = identity_cache->_keys.find(self);
+  nassertv(it != identity_cache->_keys.end());
+  identity_cache->_wrappers.erase(it->second);
+  identity_cache->_keys.erase(it);
+}
+
+/**
+ * Returns a new reference to the cached wrapper for the given pointer, or
+ * nullptr if there is none that can be used.  If the caller owns a reference
+ * to the pointer and so does the cached wrapper, the caller's reference is
+ * released.
+ */
+static PyObject *
+lookup_cached_instance(void *ptr, Dtool_PyTypedObject &type, int type_index,
+                       bool memory_rules, bool is_const) {
+  if (identity_cache == nullptr ||
+      identity_cache->_interp_id != get_current_interpreter_id()) {
+    return nullptr;
+  }
+
+  auto it = identity_cache->_wrappers.find({ptr, &type, type_index, is_const});
+  if (it == identity_cache->_wrappers.end()) {
+    return nullptr;
+  }
+
+  Dtool_PyInstDef *self = (Dtool_PyInstDef *)it->second;
+  if (memory_rules) {
+    if (!self->_memory_rules) {
+      // The wrapper doesn't own the pointer yet, so it can take over the
+      // caller's reference.
+      self->_memory_rules = true;
+
+    } else if (type._Dtool_Unref != nullptr) {
+      // Both own a reference, which can only happen for a reference-counted
+      // object.  The wrapper's reference is enough to keep it alive.
+      type._Dtool_Unref(ptr);
+
+    } else {
+      return nullptr;
+    }
+  }
+  return Py_NewRef((PyObject *)self);
+}
+
+/**
+ * Registers a newly created wrapper for the given pointer in the identity
+ * cache, if it is enabled.
+ */
+static void
+cache_instance(Dtool_PyInstDef *self, void *ptr, Dtool_PyTypedObject &type,
+               int type_index, bool is_const) {
+  if (identity_cache == nullptr || self->_is_cached ||
+      identity_cache->_interp_id != get_current_interpreter_id()) {
+    return;
+  }
+
+  IdentityKey key = {ptr, &type, type_index, is_const};
+  if (identity_cache->_wrappers.insert({key, (PyObject *)self}).second) {
+    identity_cache->_keys[(PyObject *)self] = key;
+    self->_is_cached = true;
+  }
+}
+
 /**
 
  */
@@ -263,6 +442,11 @@ PyObject *DTool_CreatePyInstanceTyped(void *local_this_in, Dtool_PyTypedObject &
   // for whatever reason.
   nassertr(local_this_in != nullptr, nullptr);
 
+  PyObject *cached = lookup_cached_instance(local_this_in, known_class_type, type_index, memory_rules, is_const);
+  if (cached != nullptr) {
+    return cached;
+  }
+
   // IF the class is possibly a run time typed object
   if (type_index > 0) {
     // get best fit class...
@@ -270,19 +454,21 @@ PyObject *DTool_CreatePyInstanceTyped(void *local_this_in, Dtool_PyTypedObject &
     if (self != nullptr) {
       self->_memory_rules = memory_rules;
       self->_is_const = is_const;
+      cache_instance(self, local_this_in, known_class_type, type_index, is_const);
       return (PyObject *)self;
     }
   }
 
   // if we get this far .. just wrap the thing in the known type ?? better
   // than aborting...I guess....
-  Dtool_PyInstDef *self = (Dtool_PyInstDef *)PyType_GenericAlloc(&known_class_type._PyType, 0);
+  Dtool_PyInstDef *self = Dtool_AllocInstance(known_class_type);
   if (self != nullptr) {
     self->_signature = PY_PANDA_SIGNATURE;
     self->_My_Type = &known_class_type;
     self->_ptr_to_object = local_this_in;
     self->_memory_rules = memory_rules;
     self->_is_const = is_const;
+    cache_instance(self, local_this_in, known_class_type, type_index, is_const);
   }
   return (PyObject *)self;
 }
@@ -296,7 +482,12 @@ PyObject *DTool_CreatePyInstance(void *local_this, Dtool_PyTypedObject &in_class
     return Py_NewRef(Py_None);
   }
 
-  Dtool_PyInstDef *self = (Dtool_PyInstDef *)PyType_GenericAlloc(&in_classdef._PyType, 0);
+  PyObject *cached = lookup_cached_instance(local_this, in_classdef, 0, memory_rules, is_const);
+  if (cached != nullptr) {
+    return cached;
+  }
+
+  Dtool_PyInstDef *self = Dtool_AllocInstance(in_classdef);
   if (self != nullptr) {
     self->_signature = PY_PANDA_SIGNATURE;
     self->_My_Type = &in_classdef;
@@ -304,8 +495,254 @@ PyObject *DTool_CreatePyInstance(void *local_this, Dtool_PyTypedObject &in_class
     self->_memory_rules = memory_rules;
     self->_is_const = is_const;
     self->_My_Type = &in_classdef;
+    cache_instance(self, local_this, in_classdef, 0, is_const);
   }
   return (PyObject *)self;
 }
 
+/**
+ * Registered with the atexit module of the interpreter that enabled a free
+ * list, so that the instances it holds are freed before the interpreter goes
+ * away.  The capsule holds the Dtool_PyTypedObject.
+ */
+static PyObject *
+free_list_atexit(PyObject *capsule, PyObject *) {
+  Dtool_PyTypedObject *type = (Dtool_PyTypedObject *)PyCapsule_GetPointer(capsule, nullptr);
+  if (type != nullptr) {
+    Dtool_DisableFreeList(*type);
+  }
+  return Py_NewRef(Py_None);
+}
+
+/**
+ * Takes all of the instances off the given free list, and frees them.
+ */
+static void
+free_list_release(Dtool_PyTypedObject &type, Dtool_PyInstDef *head) {
+  while (head != nullptr) {
+    Dtool_PyInstDef *next = (Dtool_PyInstDef *)head->_ptr_to_object;
+    type._PyType.tp_free(head);
+    head = next;
+  }
+}
+
+/**
+ * Enables a free list for instances of the given type, which holds on to up
+ * to max_size deallocated instances so that they can be reused without going
+ * through the allocator.  This is worthwhile for small value types that are
+ * frequently returned by value.  May be called again to change max_size.
+ *
+ * The free list serves only the calling interpreter, and is disabled again
+ * when that interpreter is finalized.  Returns false if the type
+ * participates in garbage collection, if the list is already enabled for
+ * another interpreter, or if it could not be registered with atexit.
+ */
+bool Dtool_EnableFreeList(Dtool_PyTypedObject &type, size_t max_size) {
+  if (type._PyType.tp_flags & Py_TPFLAGS_HAVE_GC) {
+    return false;
+  }
+
+  Dtool_FreeList &list = type._free_list;
+  PY_INT64_T interp_id = get_current_interpreter_id();
+  PY_INT64_T owner_id = list._interp_id.load(std::memory_order_relaxed);
+  if (owner_id == interp_id) {
+#ifdef Py_GIL_DISABLED
+    PyMutex_Lock(&list._lock);
+#endif
+    list._max_size = max_size;
+#ifdef Py_GIL_DISABLED
+    PyMutex_Unlock(&list._lock);
+#endif
+    return true;
+  }
+  if (owner_id >= 0) {
+    return false;
+  }
+
+  // Make sure the list is emptied while the interpreter still exists.
+  static PyMethodDef atexit_def = {
+    "_free_list_atexit", &free_list_atexit, METH_NOARGS, nullptr
+  };
+  PyObject *result = nullptr;
+  PyObject *capsule = PyCapsule_New((void *)&type, nullptr, nullptr);
+  PyObject *func = (capsule != nullptr) ? PyCFunction_New(&atexit_def, capsule) : nullptr;
+  PyObject *atexit = (func != nullptr) ? PyImport_ImportModule("atexit") : nullptr;
+  if (atexit != nullptr) {
+    result = PyObject_CallMethod(atexit, "register", "O", func);
+  }
+  Py_XDECREF(atexit);
+  Py_XDECREF(func);
+  Py_XDECREF(capsule);
+  if (result == nullptr) {
+    PyErr_Clear();
+    return false;
+  }
+  Py_DECREF(result);
+
+#ifdef Py_GIL_DISABLED
+  PyMutex_Lock(&list._lock);
+#endif
+  // Another interpreter may have claimed the list in the meantime.
+  owner_id = list._interp_id.load(std::memory_order_relaxed);
+  if (owner_id < 0 || owner_id == interp_id) {
+    list._max_size = max_size;
+    list._interp_id.store(interp_id, std::memory_order_relaxed);
+  }
+#ifdef Py_GIL_DISABLED
+  PyMutex_Unlock(&list._lock);
+#endif
+  return (owner_id < 0 || owner_id == interp_id);
+}
+
+/**
+ * Disables the free list of the given type, if it was enabled for the calling
+ * interpreter, and frees the instances it holds.  This happens automatically
+ * when the interpreter is finalized.
+ */
+void Dtool_DisableFreeList(Dtool_PyTypedObject &type) {
+  Dtool_FreeList &list = type._free_list;
+  Dtool_PyInstDef *head = nullptr;
+
+#ifdef Py_GIL_DISABLED
+  PyMutex_Lock(&list._lock);
+#endif
+  if (list._interp_id.load(std::memory_order_relaxed) == get_current_interpreter_id()) {
+    list._interp_id.store(-1, std::memory_order_relaxed);
+    head = list._head;
+    list._head = nullptr;
+    list._size = 0;
+  }
+#ifdef Py_GIL_DISABLED
+  PyMutex_Unlock(&list._lock);
+#endif
+
+  free_list_release(type, head);
+}
+
+/**
+ * Frees all of the instances currently held by the free list of the given
+ * type, if it is enabled for the calling interpreter.  The free list remains
+ * enabled.
+ */
+void Dtool_ClearFreeList(Dtool_PyTypedObject &type) {
+  Dtool_FreeList &list = type._free_list;
+  Dtool_PyInstDef *head = nullptr;
+
+#ifdef Py_GIL_DISABLED
+  PyMutex_Lock(&list._lock);
+#endif
+  if (list._interp_id.load(std::memory_order_relaxed) == get_current_interpreter_id()) {
+    head = list._head;
+    list._head = nullptr;
+    list._size = 0;
+  }
+#ifdef Py_GIL_DISABLED
+  PyMutex_Unlock(&list._lock);
+#endif
+
+  free_list_release(type, head);
+}
+
+/**
+ * Takes an instance from the free list of the given type, or allocates a new
+ * one if the list is empty.  Use Dtool_AllocInstance() instead.
+ */
+Dtool_PyInstDef *_Dtool_FreeList_Pop(Dtool_PyTypedObject &type) {
+  Dtool_FreeList &list = type._free_list;
+  Dtool_PyInstDef *self = nullptr;
+
+  PY_INT64_T interp_id = get_current_interpreter_id();
+  if (list._interp_id.load(std::memory_order_relaxed) == interp_id) {
+#ifdef Py_GIL_DISABLED
+    PyMutex_Lock(&list._lock);
+#endif
+    // Check again, in case the list was disabled in the meantime.
+    if (list._interp_id.load(std::memory_order_relaxed) == interp_id) {
+      self = list._head;
+      if (self != nullptr) {
+        // The link to the next entry is stored in the object pointer.
+        list._head = (Dtool_PyInstDef *)self->_ptr_to_object;
+        --list._size;
+      }
+    }
+#ifdef Py_GIL_DISABLED
+    PyMutex_Unlock(&list._lock);
+#endif
+    if (self != nullptr) {
+      list._num_hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      list._num_misses.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  if (self == nullptr) {
+    return (Dtool_PyInstDef *)PyType_GenericAlloc(&type._PyType, 0);
+  }
+
+  // Make it look like it came fresh out of PyType_GenericAlloc.
+  memset((char *)self + sizeof(PyObject), 0, type._PyType.tp_basicsize - sizeof(PyObject));
+  (void)PyObject_Init((PyObject *)self, &type._PyType);
+  return self;
+}
+
+/**
+ * Adds an instance that is being deallocated to the free list of the given
+ * type.  Returns false if it could not be added, in which case the caller
+ * should free it as usual.  Use Dtool_ReleaseInstance() instead.
+ */
+bool _Dtool_FreeList_Push(Dtool_PyTypedObject &type, PyObject *self) {
+  Dtool_FreeList &list = type._free_list;
+  PY_INT64_T interp_id = get_current_interpreter_id();
+  if (Py_TYPE(self) != &type._PyType ||
+      list._interp_id.load(std::memory_order_relaxed) != interp_id) {
+    return false;
+  }
+
+#ifdef Py_GIL_DISABLED
+  PyMutex_Lock(&list._lock);
+#endif
+  bool enabled = (list._interp_id.load(std::memory_order_relaxed) == interp_id);
+  bool added = (enabled && list._size < list._max_size);
+  if (added) {
+    ((Dtool_PyInstDef *)self)->_ptr_to_object = list._head;
+    list._head = (Dtool_PyInstDef *)self;
+    ++list._size;
+  }
+#ifdef Py_GIL_DISABLED
+  PyMutex_Unlock(&list._lock);
+#endif
+  if (enabled && !added) {
+    list._num_overflows.fetch_add(1, std::memory_order_relaxed);
+  }
+  return added;
+}
+
+/**
+ * Returns the counters of the free list of the given type.  The counters
+ * accumulate over the lifetime of the process, also while the list is
+ * disabled or enabled for another interpreter; the size is that of the list
+ * at the time of the call.  Since the counters are not read under the lock,
+ * they may be slightly out of step with each other under free-threading.
+ */
+Dtool_FreeListStats Dtool_GetFreeListStats(Dtool_PyTypedObject *type) {
+  Dtool_FreeListStats stats = {};
+  if (type == nullptr) {
+    return stats;
+  }
+
+  Dtool_FreeList &list = type->_free_list;
+  stats._num_hits = list._num_hits.load(std::memory_order_relaxed);
+  stats._num_misses = list._num_misses.load(std::memory_order_relaxed);
+  stats._num_overflows = list._num_overflows.load(std::memory_order_relaxed);
+#ifdef Py_GIL_DISABLED
+  PyMutex_Lock(&list._lock);
+#endif
+  stats._size = list._size;
+  stats._max_size = list._max_size;
+#ifdef Py_GIL_DISABLED
+  PyMutex_Unlock(&list._lock);
+#endif
+  return stats;
+}
+
 #endif  // HAVE_PYTHON
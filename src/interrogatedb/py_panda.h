@@ -5,6 +5,7 @@
 #ifndef PY_PANDA_H_
 #define PY_PANDA_H_
 
+#include <atomic>
 #include <set>
 #include <map>
 #include <string>
@@ -32,11 +33,46 @@
 struct Dtool_PyInstDef;
 struct Dtool_PyTypedObject;
 
+// A bounded cache of deallocated instances of a particular Dtool type, which
+// saves a trip through the general-purpose allocator for value types that are
+// created and destroyed at a high rate.  It only serves the interpreter that
+// enabled it, and only instances of the exact type, not of subclasses.
+struct Dtool_FreeList {
+  // The ID of the interpreter that the list serves, or -1 while the list is
+  // disabled.
+  std::atomic<PY_INT64_T> _interp_id { -1 };
+  Dtool_PyInstDef *_head = nullptr;
+  size_t _size = 0;
+  size_t _max_size = 0;
+
+  // These count how often an allocation was served from the free list, how
+  // often it had to fall back to the allocator, and how often an instance
+  // was freed because the list was full.  They are updated outside the lock.
+  std::atomic<size_t> _num_hits { 0 };
+  std::atomic<size_t> _num_misses { 0 };
+  std::atomic<size_t> _num_overflows { 0 };
+
+#ifdef Py_GIL_DISABLED
+  PyMutex _lock { 0 };
+#endif
+};
+
+// A snapshot of the counters of a Dtool_FreeList, as returned by
+// Dtool_GetFreeListStats().
+struct Dtool_FreeListStats {
+  size_t _num_hits;
+  size_t _num_misses;
+  size_t _num_overflows;
+  size_t _size;
+  size_t _max_size;
+};
+
 // used to stamp dtool instance..
 #define PY_PANDA_SIGNATURE 0xbeaf
 typedef void *(*UpcastFunction)(PyObject *,Dtool_PyTypedObject *);
 typedef PyObject *(*WrapFunction)(void *, PyTypeObject *);
 typedef void *(*CoerceFunction)(PyObject *, void *);
+typedef void (*UnrefFunction)(void *);
 typedef void (*ModuleClassInitFunction)(PyObject *module);
 
 // INSTANCE CONTAINER FOR ALL panda py objects....
@@ -60,6 +96,9 @@ struct Dtool_PyInstDef {
 
   // True if this is a "const" pointer.
   bool _is_const;
+
+  // True if this instance is registered in the identity cache.
+  bool _is_cached;
 };
 
 // The Class Definition Structor For a Dtool python type.
@@ -77,6 +116,13 @@ struct Dtool_PyTypedObject {
 
   CoerceFunction _Dtool_ConstCoerce;
   CoerceFunction _Dtool_Coerce;
+
+  // Releases a reference to a pointer of this type.  Only set for classes
+  // that inherit from ReferenceCount.
+  UnrefFunction _Dtool_Unref;
+
+  // Disabled unless Dtool_EnableFreeList() has been called for this type.
+  Dtool_FreeList _free_list;
 };
 
 // Extract the PyTypeObject pointer corresponding to a Dtool_PyTypedObject.
@@ -92,7 +138,7 @@ struct Dtool_PyTypedObject {
 #define DtoolInstance_IS_CONST(obj) (((Dtool_PyInstDef *)obj)->_is_const)
 #define DtoolInstance_VOID_PTR(obj) (((Dtool_PyInstDef *)obj)->_ptr_to_object)
 #define DtoolInstance_INIT_PTR(obj, ptr) { ((Dtool_PyInstDef *)obj)->_ptr_to_object = (void*)(ptr); }
-#define DtoolInstance_UPCAST(obj, type) (((Dtool_PyInstDef *)(obj))->_My_Type->_Dtool_UpcastInterface((obj), &(type)))
+#define DtoolInstance_UPCAST(obj, type) (DtoolInstance_Upcast((obj), &(type)))
 
 class DtoolProxy {
 public:
@@ -100,6 +146,28 @@ public:
   TypeHandle _type;
 };
 
+ALWAYS_INLINE void *DtoolInstance_Upcast(PyObject *self, Dtool_PyTypedObject *type);
+
+// These are used by the generated code to classify the arguments passed to an
+// overloaded function once, so that it can skip the overloads that could not
+// possibly accept them without trying to parse the arguments for each one.
+enum DtoolArgKind {
+  DAK_none = 0x01,
+  DAK_number = 0x02,
+  DAK_string = 0x04,
+  DAK_instance = 0x08,
+  DAK_other = 0x10,
+
+  // These are the sets of kinds accepted by the various parameter types.
+  DAK_number_like = DAK_number | DAK_instance | DAK_other,
+  DAK_string_like = DAK_string | DAK_instance | DAK_other,
+  DAK_instance_or_none = DAK_instance | DAK_none,
+  DAK_any = 0x1f,
+};
+
+ALWAYS_INLINE int Dtool_ClassifyArg(PyObject *arg);
+ALWAYS_INLINE void Dtool_ClassifyArgs(PyObject *args, int *kinds, Py_ssize_t num_kinds);
+
 /**
 
  */
@@ -151,6 +219,22 @@ template<class T> INLINE PyObject *DTool_CreatePyInstance(T *obj, bool memory_ru
 template<class T> INLINE PyObject *DTool_CreatePyInstanceTyped(const T *obj, bool memory_rules);
 template<class T> INLINE PyObject *DTool_CreatePyInstanceTyped(T *obj, bool memory_rules);
 
+// Functions for managing the optional per-type free lists.
+EXPCL_PYPANDA bool Dtool_EnableFreeList(Dtool_PyTypedObject &type, size_t max_size);
+EXPCL_PYPANDA void Dtool_DisableFreeList(Dtool_PyTypedObject &type);
+EXPCL_PYPANDA void Dtool_ClearFreeList(Dtool_PyTypedObject &type);
+EXPCL_PYPANDA Dtool_FreeListStats Dtool_GetFreeListStats(Dtool_PyTypedObject *type);
+EXPCL_PYPANDA Dtool_PyInstDef *_Dtool_FreeList_Pop(Dtool_PyTypedObject &type);
+EXPCL_PYPANDA bool _Dtool_FreeList_Push(Dtool_PyTypedObject &type, PyObject *self);
+ALWAYS_INLINE Dtool_PyInstDef *Dtool_AllocInstance(Dtool_PyTypedObject &type);
+ALWAYS_INLINE void Dtool_ReleaseInstance(PyObject *self, Dtool_PyTypedObject &type);
+
+// Functions for managing the optional identity cache.
+EXPCL_PYPANDA bool Dtool_EnableIdentityCache();
+EXPCL_PYPANDA void Dtool_DisableIdentityCache();
+EXPCL_PYPANDA void _Dtool_UncacheInstance(PyObject *self);
+ALWAYS_INLINE void Dtool_UncacheInstance(PyObject *self);
+
 // The finalizer for simple instances.
 INLINE int DTool_PyInit_Finalize(PyObject *self, void *This, Dtool_PyTypedObject *type, bool memory_rules, bool is_const);
 
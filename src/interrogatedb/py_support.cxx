@@ -431,6 +431,7 @@ PyObject *Dtool_BorrowThisReference(PyObject *self, PyObject *args) {
 
       // if (PyObject_TypeCheck(to_in, Py_TYPE(from_in))) {
       if (from->_My_Type == to->_My_Type) {
+        Dtool_UncacheInstance(to_in);
         to->_memory_rules = false;
         to->_is_const = from->_is_const;
         to->_ptr_to_object = from->_ptr_to_object;
@@ -610,4 +611,387 @@ bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *args, PyObject *kwds)
   return (PyTuple_GET_SIZE(args) == 0);
 }
 
+/**
+ * A more efficient version of PyArg_ParseTupleAndKeywords for functions that
+ * take several arguments.  Fills in result with max_args borrowed references,
+ * or nullptr for each optional argument that was not given.  The arguments
+ * are not converted; the caller should use Dtool_ConvertArg for that.
+ *
+ * An empty string in keywords indicates a positional-only parameter.  names
+ * should point to a static array of max_args pointers that is initially zero;
+ * it is filled in with interned versions of the keywords on first use, which
+ * allows matching most keyword arguments with a pointer comparison.  The
+ * array may be shared between threads even when the GIL is disabled.
+ *
+ * Returns false with a TypeError set if the arguments don't match.
+ */
+bool Dtool_ExtractArgs(PyObject **result, PyObject *args, PyObject *kwds,
+                       const char *function_name, const char *const keywords[],
+                       std::atomic<PyObject *> names[], Py_ssize_t min_args,
+                       Py_ssize_t max_args) {
+
+  Py_ssize_t num_args = PyTuple_GET_SIZE(args);
+  Py_ssize_t num_kwds = (kwds != nullptr) ? PyDict_GET_SIZE(kwds) : 0;
+  if (num_args + num_kwds > max_args) {
+    PyErr_Format(PyExc_TypeError,
+                 "%s() takes at most %zd arguments (%zd given)",
+                 function_name, max_args, num_args + num_kwds);
+    return false;
+  }
+
+  Py_ssize_t i;
+  for (i = 0; i < num_args; ++i) {
+    result[i] = PyTuple_GET_ITEM(args, i);
+  }
+  for (; i < max_args; ++i) {
+    result[i] = nullptr;
+  }
+
+  if (num_kwds > 0) {
+    // The last parameter always has a name if any of them do.  It is stored
+    // last, so once it is set, the other names are also visible.
+    if (names[max_args - 1].load(std::memory_order_acquire) == nullptr) {
+#ifdef Py_GIL_DISABLED
+      static PyMutex lock;
+      PyMutex_Lock(&lock);
+#endif
+      if (names[max_args - 1].load(std::memory_order_relaxed) == nullptr) {
+        for (i = 0; i < max_args; ++i) {
+          if (keywords[i][0] != 0) {
+#if PY_MAJOR_VERSION >= 3
+            PyObject *name = PyUnicode_InternFromString(keywords[i]);
+#else
+            PyObject *name = PyString_InternFromString(keywords[i]);
+#endif
+            names[i].store(name, (i == max_args - 1) ? std::memory_order_release
+                                                     : std::memory_order_relaxed);
+          }
+        }
+      }
+#ifdef Py_GIL_DISABLED
+      PyMutex_Unlock(&lock);
+#endif
+    }
+
+    PyObject *key;
+    PyObject *value;
+    Py_ssize_t ppos = 0;
+    while (PyDict_Next(kwds, &ppos, &key, &value)) {
+      // Keywords passed in a call are usually interned, so try matching the
+      // pointers first, before falling back to comparing the strings.
+      for (i = 0; i < max_args; ++i) {
+        if (names[i].load(std::memory_order_relaxed) == key) {
+          break;
+        }
+      }
+      if (i == max_args) {
+#if PY_MAJOR_VERSION >= 3
+        if (!PyUnicode_Check(key)) {
+#else
+        if (!PyString_Check(key)) {
+#endif
+          PyErr_SetString(PyExc_TypeError, "keywords must be strings");
+          return false;
+        }
+        for (i = 0; i < max_args; ++i) {
+          PyObject *name = names[i].load(std::memory_order_relaxed);
+#if PY_MAJOR_VERSION >= 3
+          if (name != nullptr && PyUnicode_Compare(key, name) == 0) {
+#else
+          if (name != nullptr && strcmp(PyString_AS_STRING(key), keywords[i]) == 0) {
+#endif
+            break;
+          }
+        }
+        if (i == max_args) {
+#if PY_MAJOR_VERSION >= 3
+          PyErr_Format(PyExc_TypeError,
+                       "'%U' is an invalid keyword argument for %s()",
+                       key, function_name);
+#else
+          PyErr_Format(PyExc_TypeError,
+                       "'%s' is an invalid keyword argument for %s()",
+                       PyString_AS_STRING(key), function_name);
+#endif
+          return false;
+        }
+      }
+      if (result[i] != nullptr) {
+        PyErr_Format(PyExc_TypeError,
+                     "argument for %s() given by name ('%s') and position (%zd)",
+                     function_name, keywords[i], i + 1);
+        return false;
+      }
+      result[i] = value;
+    }
+  }
+
+  for (i = 0; i < min_args; ++i) {
+    if (result[i] == nullptr) {
+      if (keywords[i][0] != 0) {
+        PyErr_Format(PyExc_TypeError,
+                     "%s() missing required argument '%s' (pos %zd)",
+                     function_name, keywords[i], i + 1);
+      } else {
+        PyErr_Format(PyExc_TypeError,
+                     "%s() takes at least %zd positional arguments (%zd given)",
+                     function_name, min_args, num_args);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Getter for a data member described by a Dtool_MemberDef.  The value is
+ * read directly from the C++ object, without calling a generated wrapper.
+ */
+PyObject *Dtool_GetMember(PyObject *self, void *closure) {
+  Dtool_MemberDef *def = (Dtool_MemberDef *)closure;
+  void *ptr;
+  if (!Dtool_Call_ExtractThisPointer(self, *def->_type, &ptr)) {
+    return nullptr;
+  }
+  return PyMember_GetOne((const char *)ptr, &def->_member);
+}
+
+/**
+ * Setter for a data member described by a Dtool_MemberDef.  Values are
+ * converted the same way as by the generated setters; in particular, integer
+ * values are range-checked rather than truncated.
+ */
+int Dtool_SetMember(PyObject *self, PyObject *value, void *closure) {
+  Dtool_MemberDef *def = (Dtool_MemberDef *)closure;
+  char *ptr;
+  if (!Dtool_Call_ExtractThisPointer_NonConst(self, *def->_type, (void **)&ptr, def->_full_name)) {
+    return -1;
+  }
+  if (value == nullptr) {
+    return Dtool_Raise_CantDeleteAttributeError(def->_member.name);
+  }
+  ptr += def->_member.offset;
+
+  switch (def->_member.type) {
+  case T_BOOL:
+    {
+      int truth = PyObject_IsTrue(value);
+      if (truth < 0) {
+        return -1;
+      }
+      *(bool *)ptr = (truth != 0);
+    }
+    return 0;
+
+  case T_FLOAT:
+  case T_DOUBLE:
+    {
+      double dval = PyFloat_AsDouble(value);
+      if (dval == -1.0 && PyErr_Occurred()) {
+        return -1;
+      }
+      if (def->_member.type == T_FLOAT) {
+        *(float *)ptr = (float)dval;
+      } else {
+        *(double *)ptr = dval;
+      }
+    }
+    return 0;
+
+  default:
+    break;
+  }
+
+  if (!PyLongOrInt_Check(value)) {
+    PyErr_Format(PyExc_TypeError, "%s must be an integer, not %s",
+                 def->_full_name, Py_TYPE(value)->tp_name);
+    return -1;
+  }
+
+  switch (def->_member.type) {
+  case T_SHORT:
+  case T_INT:
+  case T_LONG:
+  case T_LONGLONG:
+    {
+      PY_LONG_LONG lval = PyLong_AsLongLong(value);
+      if (lval == -1 && PyErr_Occurred()) {
+        return -1;
+      }
+      switch (def->_member.type) {
+      case T_SHORT:
+        if (lval < SHRT_MIN || lval > SHRT_MAX) {
+          break;
+        }
+        *(short *)ptr = (short)lval;
+        return 0;
+      case T_INT:
+        if (lval < INT_MIN || lval > INT_MAX) {
+          break;
+        }
+        *(int *)ptr = (int)lval;
+        return 0;
+      case T_LONG:
+        if (lval < LONG_MIN || lval > LONG_MAX) {
+          break;
+        }
+        *(long *)ptr = (long)lval;
+        return 0;
+      default:
+        *(PY_LONG_LONG *)ptr = lval;
+        return 0;
+      }
+    }
+    break;
+
+  case T_USHORT:
+  case T_UINT:
+  case T_ULONG:
+  case T_ULONGLONG:
+    {
+      unsigned PY_LONG_LONG ulval = PyLong_AsUnsignedLongLong(value);
+      if (ulval == (unsigned PY_LONG_LONG)-1 && PyErr_Occurred()) {
+        return -1;
+      }
+      switch (def->_member.type) {
+      case T_USHORT:
+        if (ulval > USHRT_MAX) {
+          break;
+        }
+        *(unsigned short *)ptr = (unsigned short)ulval;
+        return 0;
+      case T_UINT:
+        if (ulval > UINT_MAX) {
+          break;
+        }
+        *(unsigned int *)ptr = (unsigned int)ulval;
+        return 0;
+      case T_ULONG:
+        if (ulval > ULONG_MAX) {
+          break;
+        }
+        *(unsigned long *)ptr = (unsigned long)ulval;
+        return 0;
+      default:
+        *(unsigned PY_LONG_LONG *)ptr = ulval;
+        return 0;
+      }
+    }
+    break;
+
+  default:
+    PyErr_Format(PyExc_TypeError, "%s cannot be assigned", def->_full_name);
+    return -1;
+  }
+
+  PyErr_Format(PyExc_OverflowError, "value out of range for %s",
+               def->_full_name);
+  return -1;
+}
+
+/**
+ * Fills in a Py_buffer describing a contiguous one-dimensional array of count
+ * elements of the given size, for use by the generated bf_getbuffer slots of
+ * classes that are backed by a vector.
+ *
+ * The buffer holds a read-only copy of the data, since nothing stops the
+ * vector from being resized (and its storage reallocated) while a view of it
+ * is still alive.  The copy is allocated on the heap along with the shape and
+ * strides, so the buffer must be released with Dtool_ReleaseVectorBuffer.
+ */
+int Dtool_GetVectorBuffer(PyObject *self, Py_buffer *view, int flags,
+                          const void *data, Py_ssize_t count,
+                          Py_ssize_t itemsize, const char *format) {
+  if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "Object is not writable.");
+    view->obj = nullptr;
+    return -1;
+  }
+
+  // The shape and strides come first, so that the data is suitably aligned.
+  Py_ssize_t *shape = (Py_ssize_t *)PyMem_Malloc(sizeof(Py_ssize_t) * 2 + count * itemsize);
+  if (shape == nullptr) {
+    PyErr_NoMemory();
+    view->obj = nullptr;
+    return -1;
+  }
+  shape[0] = count;
+  shape[1] = itemsize;
+  if (count > 0) {
+    memcpy(shape + 2, data, count * itemsize);
+  }
+
+  Py_INCREF(self);
+  view->obj = self;
+  view->buf = (void *)(shape + 2);
+  view->len = count * itemsize;
+  view->readonly = 1;
+  view->itemsize = itemsize;
+  view->format = nullptr;
+  if ((flags & PyBUF_FORMAT) == PyBUF_FORMAT) {
+    view->format = (char *)format;
+  }
+  view->ndim = 1;
+  view->shape = nullptr;
+  if ((flags & PyBUF_ND) == PyBUF_ND) {
+    view->shape = shape;
+  }
+  view->strides = nullptr;
+  if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) {
+    view->strides = shape + 1;
+  }
+  view->suboffsets = nullptr;
+  view->internal = (void *)shape;
+  return 0;
+}
+
+/**
+ * Releases a buffer that was filled in by Dtool_GetVectorBuffer.
+ */
+void Dtool_ReleaseVectorBuffer(PyObject *self, Py_buffer *view) {
+  PyMem_Free(view->internal);
+  view->internal = nullptr;
+}
+
+#if PY_VERSION_HEX >= 0x03090000
+/**
+ * Constructs an instance of the given type by way of type.__call__, after
+ * converting the vectorcall arguments to a tuple and dict.  This is used by
+ * the generated tp_vectorcall implementations for the cases they don't handle
+ * themselves.
+ */
+PyObject *Dtool_CallTypeGeneric(PyObject *type, PyObject *const *args,
+                                size_t nargsf, PyObject *kwnames) {
+  Py_ssize_t nargs = PyVectorcall_NARGS(nargsf);
+  PyObject *tuple = PyTuple_New(nargs);
+  if (tuple == nullptr) {
+    return nullptr;
+  }
+  for (Py_ssize_t i = 0; i < nargs; ++i) {
+    PyTuple_SET_ITEM(tuple, i, Py_NewRef(args[i]));
+  }
+
+  PyObject *kwds = nullptr;
+  if (kwnames != nullptr && PyTuple_GET_SIZE(kwnames) != 0) {
+    kwds = PyDict_New();
+    if (kwds == nullptr) {
+      Py_DECREF(tuple);
+      return nullptr;
+    }
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(kwnames); ++i) {
+      if (PyDict_SetItem(kwds, PyTuple_GET_ITEM(kwnames, i), args[nargs + i]) != 0) {
+        Py_DECREF(tuple);
+        Py_DECREF(kwds);
+        return nullptr;
+      }
+    }
+  }
+
+  PyObject *result = PyType_Type.tp_call(type, tuple, kwds);
+  Py_DECREF(tuple);
+  Py_XDECREF(kwds);
+  return result;
+}
+#endif  // PY_VERSION_HEX >= 0x03090000
+
 #endif  // HAVE_PYTHON
@@ -39,7 +39,9 @@ using namespace std;
 #define Define_Dtool_new(CLASS_NAME,CNAME)\
 static PyObject *Dtool_new_##CLASS_NAME(PyTypeObject *type, PyObject *args, PyObject *kwds) {\
   (void) args; (void) kwds;\
-  PyObject *self = type->tp_alloc(type, 0);\
+  PyObject *self = (type == &Dtool_##CLASS_NAME._PyType)\
+    ? (PyObject *)Dtool_AllocInstance(Dtool_##CLASS_NAME)\
+    : type->tp_alloc(type, 0);\
   ((Dtool_PyInstDef *)self)->_signature = PY_PANDA_SIGNATURE;\
   ((Dtool_PyInstDef *)self)->_My_Type = &Dtool_##CLASS_NAME;\
   return self;\
@@ -55,55 +57,67 @@ static PyObject *Dtool_new_##CLASS_NAME(PyTypeObject *type, PyObject *args, PyOb
 #ifdef NDEBUG
 #define Define_Dtool_FreeInstance_Private(CLASS_NAME,CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_UncacheInstance(self);\
+  Dtool_ReleaseInstance(self, Dtool_##CLASS_NAME);\
 }
 #else // NDEBUG
 #define Define_Dtool_FreeInstance_Private(CLASS_NAME,CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
+  Dtool_UncacheInstance(self);\
   if (DtoolInstance_VOID_PTR(self) != nullptr) {\
     if (((Dtool_PyInstDef *)self)->_memory_rules) {\
       std::cerr << "Detected leak for " << #CLASS_NAME \
            << " which interrogate cannot delete.\n"; \
     }\
   }\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_ReleaseInstance(self, Dtool_##CLASS_NAME);\
 }
 #endif  // NDEBUG
 
 #define Define_Dtool_FreeInstance(CLASS_NAME,CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
+  Dtool_UncacheInstance(self);\
   if (DtoolInstance_VOID_PTR(self) != nullptr) {\
     if (((Dtool_PyInstDef *)self)->_memory_rules) {\
       delete (CNAME *)DtoolInstance_VOID_PTR(self);\
     }\
   }\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_ReleaseInstance(self, Dtool_##CLASS_NAME);\
 }
 
 #define Define_Dtool_FreeInstanceRef(CLASS_NAME,CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
+  Dtool_UncacheInstance(self);\
   if (DtoolInstance_VOID_PTR(self) != nullptr) {\
     if (((Dtool_PyInstDef *)self)->_memory_rules) {\
       unref_delete((CNAME *)DtoolInstance_VOID_PTR(self));\
     }\
   }\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_ReleaseInstance(self, Dtool_##CLASS_NAME);\
+}\
+static void Dtool_Unref_##CLASS_NAME(void *ptr) {\
+  unref_delete((CNAME *)ptr);\
 }
 
 #define Define_Dtool_FreeInstanceRef_Private(CLASS_NAME,CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
+  Dtool_UncacheInstance(self);\
   if (DtoolInstance_VOID_PTR(self) != nullptr) {\
     if (((Dtool_PyInstDef *)self)->_memory_rules) {\
       unref_delete((ReferenceCount *)(CNAME *)DtoolInstance_VOID_PTR(self));\
     }\
   }\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_ReleaseInstance(self, Dtool_##CLASS_NAME);\
+}\
+static void Dtool_Unref_##CLASS_NAME(void *ptr) {\
+  unref_delete((ReferenceCount *)(CNAME *)ptr);\
 }
 
 #define Define_Dtool_Simple_FreeInstance(CLASS_NAME, CNAME)\
 static void Dtool_FreeInstance_##CLASS_NAME(PyObject *self) {\
+  Dtool_UncacheInstance(self);\
   ((Dtool_InstDef_##CLASS_NAME *)self)->_value.~##CLASS_NAME();\
-  Py_TYPE(self)->tp_free(self);\
+  Dtool_ReleaseInstance(self, Dtool_##CLASS_NAME);\
 
 #if PY_VERSION_HEX >= 0x030d0000
 class Dtool_TypeMap : public std::map<std::string, Dtool_PyTypedObject *> {
@@ -213,6 +227,22 @@ struct LibraryDef {
   const struct InterrogateModuleDef *const _module_def;
 };
 
+/**
+ * Describes a plain data member of a wrapped class that is read and written
+ * directly at the given offset from the C++ pointer.  This is passed as the
+ * closure of a PyGetSetDef whose getter and setter are Dtool_GetMember and
+ * Dtool_SetMember.  The _member.type field holds one of the T_* codes from
+ * structmember.h.
+ */
+struct Dtool_MemberDef {
+  PyMemberDef _member;
+  Dtool_PyTypedObject *_type;
+  const char *_full_name;
+};
+
+EXPCL_PYPANDA PyObject *Dtool_GetMember(PyObject *self, void *closure);
+EXPCL_PYPANDA int Dtool_SetMember(PyObject *self, PyObject *value, void *closure);
+
 #if PY_MAJOR_VERSION >= 3
 EXPCL_PYPANDA PyObject *Dtool_PyModuleInitHelper(const LibraryDef *defs[], PyModuleDef *module_def);
 #else
@@ -253,6 +283,31 @@ EXPCL_PYPANDA bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *args,
                                             PyObject *kwds, const char *keyword);
 EXPCL_PYPANDA bool Dtool_ExtractOptionalArg(PyObject **result, PyObject *args,
                                             PyObject *kwds);
+EXPCL_PYPANDA bool Dtool_ExtractArgs(PyObject **result, PyObject *args,
+                                     PyObject *kwds, const char *function_name,
+                                     const char *const keywords[],
+                                     std::atomic<PyObject *> names[],
+                                     Py_ssize_t min_args, Py_ssize_t max_args);
+
+EXPCL_PYPANDA int Dtool_GetVectorBuffer(PyObject *self, Py_buffer *view,
+                                        int flags, const void *data,
+                                        Py_ssize_t count, Py_ssize_t itemsize,
+                                        const char *format);
+EXPCL_PYPANDA void Dtool_ReleaseVectorBuffer(PyObject *self, Py_buffer *view);
+
+#if PY_VERSION_HEX >= 0x03090000
+EXPCL_PYPANDA PyObject *Dtool_CallTypeGeneric(PyObject *type,
+                                              PyObject *const *args,
+                                              size_t nargsf, PyObject *kwnames);
+#endif
+
+ALWAYS_INLINE bool Dtool_ConvertArg(PyObject *arg, PyObject *&into);
+ALWAYS_INLINE bool Dtool_ConvertArg(PyObject *arg, double &into);
+ALWAYS_INLINE bool Dtool_ConvertArg(PyObject *arg, float &into);
+ALWAYS_INLINE bool Dtool_ConvertArg(PyObject *arg, long &into);
+ALWAYS_INLINE bool Dtool_ConvertArg(PyObject *arg, int &into);
+ALWAYS_INLINE bool Dtool_ConvertArg(PyObject *arg, PY_LONG_LONG &into);
+ALWAYS_INLINE bool Dtool_ConvertArg(PyObject *arg, unsigned PY_LONG_LONG &into);
 
 #include "py_support.I"
 
@@ -20,6 +20,10 @@
 #define Py_TPFLAGS_IMMUTABLETYPE 0
 #endif
 
+// The number of items that are fetched at a time when iterating over or
+// searching through a sequence property.
+#define DTOOL_SEQUENCE_CHUNK_SIZE 16
+
 /**
  * Registers the type with collections.abc.
  */
@@ -173,6 +177,89 @@ static PyObject *Dtool_SequenceWrapper_getitem(PyObject *self, Py_ssize_t index)
   return wrap->_getitem_func(wrap->_base._self, index);
 }
 
+/**
+ * Stores new references to up to count items of the sequence, starting at the
+ * given index, into the given array.  Uses the bulk fill function if the
+ * property provides one, otherwise calls the getitem function for each item.
+ * Returns the number of items stored, or -1 on error.
+ */
+static Py_ssize_t
+_fill_items(Dtool_SequenceWrapper *wrap, PyObject **items, Py_ssize_t start,
+            Py_ssize_t count) {
+  if (wrap->_fill_func != nullptr) {
+    return wrap->_fill_func(wrap->_base._self, items, start, count);
+  }
+
+  for (Py_ssize_t i = 0; i < count; ++i) {
+    PyObject *item = wrap->_getitem_func(wrap->_base._self, start + i);
+    if (item == nullptr) {
+      while (i > 0) {
+        --i;
+        Py_DECREF(items[i]);
+      }
+      return -1;
+    }
+    items[i] = item;
+  }
+  return count;
+}
+
+/**
+ * Searches the sequence for items equal to the given value.  Returns the
+ * index of the first match, or -1 if there is no match, or -2 on error.  If
+ * count is not null, all items are visited and the number of matches is
+ * stored in it.
+ */
+static Py_ssize_t
+_find_item(Dtool_SequenceWrapper *wrap, PyObject *value, Py_ssize_t *count) {
+  Py_ssize_t length = wrap->_len_func(wrap->_base._self);
+  if (length < 0) {
+    return -2;
+  }
+
+  // Fetch the items a chunk at a time, to avoid the overhead of a call for
+  // every item when the property supports filling them in bulk.
+  PyObject *items[DTOOL_SEQUENCE_CHUNK_SIZE];
+  Py_ssize_t found = -1;
+  Py_ssize_t start = 0;
+  while (start < length) {
+    Py_ssize_t num_items = length - start;
+    if (num_items > DTOOL_SEQUENCE_CHUNK_SIZE) {
+      num_items = DTOOL_SEQUENCE_CHUNK_SIZE;
+    }
+    num_items = _fill_items(wrap, items, start, num_items);
+    if (num_items <= 0) {
+      return (num_items < 0) ? -2 : found;
+    }
+
+    for (Py_ssize_t i = 0; i < num_items; ++i) {
+      int cmp = PyObject_RichCompareBool(items[i], value, Py_EQ);
+      if (cmp > 0) {
+        if (found < 0) {
+          found = start + i;
+        }
+        if (count != nullptr) {
+          ++(*count);
+        } else {
+          // We are only interested in the first match.
+          for (; i < num_items; ++i) {
+            Py_DECREF(items[i]);
+          }
+          return found;
+        }
+      } else if (cmp < 0) {
+        for (; i < num_items; ++i) {
+          Py_DECREF(items[i]);
+        }
+        return -2;
+      }
+      Py_DECREF(items[i]);
+    }
+    start += num_items;
+  }
+  return found;
+}
+
 /**
  * Implementation of (x in property)
  */
@@ -182,25 +269,11 @@ static int Dtool_SequenceWrapper_contains(PyObject *self, PyObject *value) {
   nassertr(wrap->_len_func, -1);
   nassertr(wrap->_getitem_func, -1);
 
-  Py_ssize_t length = wrap->_len_func(wrap->_base._self);
-
-  // Iterate through the items, invoking the equality function for each, until
-  // we have found the matching one.
-  for (Py_ssize_t index = 0; index < length; ++index) {
-    PyObject *item = wrap->_getitem_func(wrap->_base._self, index);
-    if (item != nullptr) {
-      int cmp = PyObject_RichCompareBool(item, value, Py_EQ);
-      if (cmp > 0) {
-        return 1;
-      }
-      if (cmp < 0) {
-        return -1;
-      }
-    } else {
-      return -1;
-    }
+  Py_ssize_t index = _find_item(wrap, value, nullptr);
+  if (index == -2) {
+    return -1;
   }
-  return 0;
+  return (index >= 0) ? 1 : 0;
 }
 
 /**
@@ -213,23 +286,12 @@ static PyObject *Dtool_SequenceWrapper_index(PyObject *self, PyObject *value) {
   nassertr(wrap->_len_func, nullptr);
   nassertr(wrap->_getitem_func, nullptr);
 
-  Py_ssize_t length = wrap->_len_func(wrap->_base._self);
-
-  // Iterate through the items, invoking the equality function for each, until
-  // we have found the right one.
-  for (Py_ssize_t index = 0; index < length; ++index) {
-    PyObject *item = wrap->_getitem_func(wrap->_base._self, index);
-    if (item != nullptr) {
-      int cmp = PyObject_RichCompareBool(item, value, Py_EQ);
-      if (cmp > 0) {
-        return Dtool_WrapValue(index);
-      }
-      if (cmp < 0) {
-        return nullptr;
-      }
-    } else {
-      return nullptr;
-    }
+  Py_ssize_t index = _find_item(wrap, value, nullptr);
+  if (index >= 0) {
+    return Dtool_WrapValue(index);
+  }
+  if (index == -2) {
+    return nullptr;
   }
   // Not found, raise ValueError.
   return PyErr_Format(PyExc_ValueError, "%s.index() did not find value", wrap->_base._name);
@@ -242,34 +304,227 @@ static PyObject *Dtool_SequenceWrapper_index(PyObject *self, PyObject *value) {
 static PyObject *Dtool_SequenceWrapper_count(PyObject *self, PyObject *value) {
   Dtool_SequenceWrapper *wrap = (Dtool_SequenceWrapper *)self;
   nassertr(wrap, nullptr);
-  Py_ssize_t index = 0;
-  if (wrap->_len_func != nullptr) {
-    index = wrap->_len_func(wrap->_base._self);
-  } else {
+  if (wrap->_len_func == nullptr) {
     return Dtool_Raise_TypeError("property does not support count()");
   }
-  // Iterate through the items, invoking the == operator for each.
-  long count = 0;
   nassertr(wrap->_getitem_func, nullptr);
-  while (index > 0) {
-    --index;
-    PyObject *item = wrap->_getitem_func(wrap->_base._self, index);
-    if (item == nullptr) {
+
+  Py_ssize_t count = 0;
+  if (_find_item(wrap, value, &count) == -2) {
+    return nullptr;
+  }
+#if PY_MAJOR_VERSION >= 3
+  return PyLong_FromSsize_t(count);
+#else
+  return PyInt_FromSsize_t(count);
+#endif
+}
+
+/**
+ * Implementation of property.tolist() which returns a list containing all the
+ * items in the sequence.
+ */
+static PyObject *Dtool_SequenceWrapper_tolist(PyObject *self, PyObject *) {
+  Dtool_SequenceWrapper *wrap = (Dtool_SequenceWrapper *)self;
+  nassertr(wrap, nullptr);
+  if (wrap->_len_func == nullptr) {
+    return Dtool_Raise_TypeError("property does not support tolist()");
+  }
+  nassertr(wrap->_getitem_func, nullptr);
+
+  Py_ssize_t length = wrap->_len_func(wrap->_base._self);
+  if (length < 0) {
+    return nullptr;
+  }
+
+  PyObject *list = PyList_New(length);
+  if (list == nullptr) {
+    return nullptr;
+  }
+
+  // The items are written straight into the list's storage.
+  Py_ssize_t num_items = 0;
+  if (length > 0) {
+    num_items = _fill_items(wrap, PySequence_Fast_ITEMS(list), 0, length);
+    if (num_items < 0) {
+      Py_DECREF(list);
       return nullptr;
     }
-    int cmp = PyObject_RichCompareBool(item, value, Py_EQ);
-    if (cmp > 0) {
-      ++count;
+  }
+  if (num_items < length) {
+    // The sequence shrank while we were filling it in.
+    if (PyList_SetSlice(list, num_items, length, nullptr) != 0) {
+      Py_DECREF(list);
+      return nullptr;
     }
-    if (cmp < 0) {
+  }
+  return list;
+}
+
+/**
+ * This is returned by iter(property).  It fetches the items a chunk at a time
+ * if the property supports filling them in bulk, and otherwise one at a time.
+ * The buffered items are only handed out as long as the length of the
+ * sequence stays the same as when they were fetched.
+ */
+struct Dtool_SequenceIterator {
+  PyObject_HEAD
+  Dtool_SequenceWrapper *_wrap;
+  Py_ssize_t _index;
+  Py_ssize_t _length;
+  Py_ssize_t _num_buffered;
+  Py_ssize_t _buffer_pos;
+  PyObject *_buffer[DTOOL_SEQUENCE_CHUNK_SIZE];
+};
+
+/**
+ * Releases the items in the buffer that have not been returned yet, and
+ * moves the index back so that they are fetched again.
+ */
+static void
+_discard_buffer(Dtool_SequenceIterator *iter) {
+  while (iter->_buffer_pos < iter->_num_buffered) {
+    Py_DECREF(iter->_buffer[iter->_buffer_pos++]);
+    --iter->_index;
+  }
+  iter->_num_buffered = 0;
+  iter->_buffer_pos = 0;
+}
+
+static void Dtool_SequenceIterator_dealloc(PyObject *self) {
+  Dtool_SequenceIterator *iter = (Dtool_SequenceIterator *)self;
+  PyTypeObject *tp = Py_TYPE(self);
+  while (iter->_buffer_pos < iter->_num_buffered) {
+    Py_DECREF(iter->_buffer[iter->_buffer_pos++]);
+  }
+  Py_XDECREF((PyObject *)iter->_wrap);
+  tp->tp_free(self);
+  Py_DECREF(tp);
+}
+
+static PyObject *Dtool_SequenceIterator_next(PyObject *self) {
+  Dtool_SequenceIterator *iter = (Dtool_SequenceIterator *)self;
+  Dtool_SequenceWrapper *wrap = iter->_wrap;
+  if (wrap == nullptr) {
+    return nullptr;
+  }
+
+  // Check the length again each time, in case the sequence has changed.  If
+  // it has, items may have been removed or moved, so the buffered items can
+  // no longer be trusted.
+  Py_ssize_t length = wrap->_len_func(wrap->_base._self);
+  if (length < 0) {
+    return nullptr;
+  }
+  if (iter->_buffer_pos < iter->_num_buffered) {
+    if (length == iter->_length) {
+      return iter->_buffer[iter->_buffer_pos++];
+    }
+    _discard_buffer(iter);
+  }
+  iter->_length = length;
+
+  Py_ssize_t num_items = length - iter->_index;
+  if (wrap->_fill_func == nullptr && num_items > 1) {
+    num_items = 1;
+  } else if (num_items > DTOOL_SEQUENCE_CHUNK_SIZE) {
+    num_items = DTOOL_SEQUENCE_CHUNK_SIZE;
+  }
+  if (num_items > 0) {
+    num_items = _fill_items(wrap, iter->_buffer, iter->_index, num_items);
+    if (num_items < 0 && PyErr_ExceptionMatches(PyExc_IndexError)) {
+      // The sequence shrank while we were fetching the items.  Like the
+      // iterator of any other sequence, we stop at the first index that is
+      // out of range, so fetch the next item by itself to find out where.
+      PyErr_Clear();
+      num_items = 0;
+      if (wrap->_fill_func != nullptr && wrap->_getitem_func != nullptr) {
+        PyObject *item = wrap->_getitem_func(wrap->_base._self, iter->_index);
+        if (item != nullptr) {
+          iter->_buffer[0] = item;
+          num_items = 1;
+        } else if (PyErr_ExceptionMatches(PyExc_IndexError)) {
+          PyErr_Clear();
+        } else {
+          num_items = -1;
+        }
+      }
+    }
+  }
+  if (num_items <= 0) {
+    // Exhausted, or an error occurred.
+    iter->_wrap = nullptr;
+    Py_DECREF((PyObject *)wrap);
+    return nullptr;
+  }
+
+  iter->_index += num_items;
+  iter->_num_buffered = num_items;
+  iter->_buffer_pos = 1;
+  return iter->_buffer[0];
+}
+
+static PyObject *Dtool_SequenceIterator_length_hint(PyObject *self, PyObject *) {
+  Dtool_SequenceIterator *iter = (Dtool_SequenceIterator *)self;
+  Py_ssize_t hint = 0;
+  Dtool_SequenceWrapper *wrap = iter->_wrap;
+  if (wrap != nullptr) {
+    Py_ssize_t length = wrap->_len_func(wrap->_base._self);
+    if (length < 0) {
       return nullptr;
     }
+    // The index of the next item that will be returned.
+    Py_ssize_t next = iter->_index - (iter->_num_buffered - iter->_buffer_pos);
+    if (length > next) {
+      hint = length - next;
+    }
   }
-#if PY_MAJOR_VERSION >= 3
-  return PyLong_FromLong(count);
-#else
-  return PyInt_FromLong(count);
-#endif
+  return Dtool_WrapValue(hint);
+}
+
+/**
+ * Implementation of iter(property).
+ */
+static PyObject *Dtool_SequenceWrapper_iter(PyObject *self) {
+  Dtool_SequenceWrapper *wrap = (Dtool_SequenceWrapper *)self;
+  nassertr(wrap, nullptr);
+  if (wrap->_len_func == nullptr || wrap->_getitem_func == nullptr) {
+    return PyErr_Format(PyExc_TypeError, "%s is not iterable", wrap->_base._name);
+  }
+
+  static PyMethodDef methods[] = {
+    {"__length_hint__", &Dtool_SequenceIterator_length_hint, METH_NOARGS, nullptr},
+    {nullptr, nullptr, 0, nullptr}
+  };
+
+  static PyType_Slot iterator_slots[] = {
+    {Py_tp_dealloc, (void *)&Dtool_SequenceIterator_dealloc},
+    {Py_tp_iter, (void *)&PyObject_SelfIter},
+    {Py_tp_iternext, (void *)&Dtool_SequenceIterator_next},
+    {Py_tp_methods, (void *)methods},
+    {0, nullptr},
+  };
+
+  static PyType_Spec iterator_spec = {
+    "sys._interrogate_sequence_iterator",
+    sizeof(Dtool_SequenceIterator),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE,
+    iterator_slots,
+  };
+
+  PyObject *iterator_type = _init_wrapper_type(iterator_spec);
+  nassertr_always(iterator_type != nullptr, nullptr);
+
+  Dtool_SequenceIterator *iter = PyObject_New(Dtool_SequenceIterator, (PyTypeObject *)iterator_type);
+  if (iter != nullptr) {
+    iter->_wrap = (Dtool_SequenceWrapper *)Py_NewRef(self);
+    iter->_index = 0;
+    iter->_length = 0;
+    iter->_num_buffered = 0;
+    iter->_buffer_pos = 0;
+  }
+  return (PyObject *)iter;
 }
 
 /**
@@ -514,7 +769,10 @@ static PyObject *Dtool_MappingWrapper_iter(PyObject *self) {
   if (keys != nullptr) {
     keys->_len_func = wrap->_keys._len_func;
     keys->_getitem_func = wrap->_keys._getitem_func;
-    return PySeqIter_New((PyObject *)keys);
+    keys->_fill_func = wrap->_keys._fill_func;
+    PyObject *iter = Dtool_SequenceWrapper_iter((PyObject *)keys);
+    Py_DECREF(keys);
+    return iter;
   } else {
     return nullptr;
   }
@@ -581,7 +839,7 @@ static PyObject *Dtool_MappingWrapper_keys(PyObject *self, PyObject *) {
   static PyType_Slot wrapper_slots[] = {
     {Py_tp_dealloc, (void *)&Dtool_WrapperBase_dealloc},
     {Py_tp_repr, (void *)&Dtool_MappingWrapper_Keys_repr},
-    {Py_tp_iter, (void *)&PySeqIter_New},
+    {Py_tp_iter, (void *)&Dtool_SequenceWrapper_iter},
     {Py_sq_length, (void *)&Dtool_SequenceWrapper_length},
     {Py_sq_item, (void *)&Dtool_SequenceWrapper_getitem},
     {Py_sq_contains, (void *)&Dtool_SequenceWrapper_contains},
@@ -605,6 +863,7 @@ static PyObject *Dtool_MappingWrapper_keys(PyObject *self, PyObject *) {
     keys->_base._name = wrap->_base._name;
     keys->_keys._len_func = wrap->_keys._len_func;
     keys->_keys._getitem_func = wrap->_keys._getitem_func;
+    keys->_keys._fill_func = wrap->_keys._fill_func;
     keys->_getitem_func = wrap->_getitem_func;
     keys->_setitem_func = nullptr;
   }
@@ -681,6 +940,7 @@ static PyObject *Dtool_MappingWrapper_values(PyObject *self, PyObject *) {
     values->_base._name = wrap->_base._name;
     values->_keys._len_func = wrap->_keys._len_func;
     values->_keys._getitem_func = wrap->_keys._getitem_func;
+    values->_keys._fill_func = wrap->_keys._fill_func;
     values->_getitem_func = wrap->_getitem_func;
     values->_setitem_func = nullptr;
   }
@@ -766,6 +1026,7 @@ static PyObject *Dtool_MappingWrapper_items(PyObject *self, PyObject *) {
     items->_base._name = wrap->_base._name;
     items->_keys._len_func = wrap->_keys._len_func;
     items->_keys._getitem_func = wrap->_keys._getitem_func;
+    items->_keys._fill_func = wrap->_keys._fill_func;
     items->_getitem_func = wrap->_getitem_func;
     items->_setitem_func = nullptr;
   }
@@ -1101,13 +1362,14 @@ Dtool_SequenceWrapper *Dtool_NewSequenceWrapper(PyObject *self, const char *name
   static PyMethodDef methods[] = {
     {"index", &Dtool_SequenceWrapper_index, METH_O, nullptr},
     {"count", &Dtool_SequenceWrapper_count, METH_O, nullptr},
+    {"tolist", &Dtool_SequenceWrapper_tolist, METH_NOARGS, nullptr},
     {nullptr, nullptr, 0, nullptr}
   };
 
   static PyType_Slot wrapper_slots[] = {
     {Py_tp_dealloc, (void *)&Dtool_WrapperBase_dealloc},
     {Py_tp_repr, (void *)&Dtool_SequenceWrapper_repr},
-    {Py_tp_iter, (void *)&PySeqIter_New},
+    {Py_tp_iter, (void *)&Dtool_SequenceWrapper_iter},
     {Py_sq_length, (void *)&Dtool_SequenceWrapper_length},
     {Py_sq_item, (void *)&Dtool_SequenceWrapper_getitem},
     {Py_sq_contains, (void *)&Dtool_SequenceWrapper_contains},
@@ -1132,6 +1394,7 @@ Dtool_SequenceWrapper *Dtool_NewSequenceWrapper(PyObject *self, const char *name
     wrap->_base._name = name;
     wrap->_len_func = nullptr;
     wrap->_getitem_func = nullptr;
+    wrap->_fill_func = nullptr;
   }
   return wrap;
 }
@@ -1143,6 +1406,7 @@ Dtool_MutableSequenceWrapper *Dtool_NewMutableSequenceWrapper(PyObject *self, co
   static PyMethodDef methods[] = {
     {"index", &Dtool_SequenceWrapper_index, METH_O, nullptr},
     {"count", &Dtool_SequenceWrapper_count, METH_O, nullptr},
+    {"tolist", &Dtool_SequenceWrapper_tolist, METH_NOARGS, nullptr},
     {"clear", &Dtool_MutableSequenceWrapper_clear, METH_NOARGS, nullptr},
     {"pop", &Dtool_MutableSequenceWrapper_pop, METH_VARARGS, nullptr},
     {"remove", &Dtool_MutableSequenceWrapper_remove, METH_O, nullptr},
@@ -1155,7 +1419,7 @@ Dtool_MutableSequenceWrapper *Dtool_NewMutableSequenceWrapper(PyObject *self, co
   static PyType_Slot wrapper_slots[] = {
     {Py_tp_dealloc, (void *)&Dtool_WrapperBase_dealloc},
     {Py_tp_repr, (void *)&Dtool_SequenceWrapper_repr},
-    {Py_tp_iter, (void *)&PySeqIter_New},
+    {Py_tp_iter, (void *)&Dtool_SequenceWrapper_iter},
     {Py_sq_length, (void *)&Dtool_SequenceWrapper_length},
     {Py_sq_item, (void *)&Dtool_SequenceWrapper_getitem},
     {Py_sq_ass_item, (void *)&Dtool_MutableSequenceWrapper_setitem},
@@ -1182,6 +1446,7 @@ Dtool_MutableSequenceWrapper *Dtool_NewMutableSequenceWrapper(PyObject *self, co
     wrap->_base._name = name;
     wrap->_len_func = nullptr;
     wrap->_getitem_func = nullptr;
+    wrap->_fill_func = nullptr;
     wrap->_setitem_func = nullptr;
     wrap->_insert_func = nullptr;
   }
@@ -1229,6 +1494,7 @@ Dtool_MappingWrapper *Dtool_NewMappingWrapper(PyObject *self, const char *name)
     wrap->_base._name = name;
     wrap->_keys._len_func = nullptr;
     wrap->_keys._getitem_func = nullptr;
+    wrap->_keys._fill_func = nullptr;
     wrap->_getitem_func = nullptr;
     wrap->_setitem_func = nullptr;
   }
@@ -1282,6 +1548,7 @@ Dtool_MappingWrapper *Dtool_NewMutableMappingWrapper(PyObject *self, const char
     wrap->_base._name = name;
     wrap->_keys._len_func = nullptr;
     wrap->_keys._getitem_func = nullptr;
+    wrap->_keys._fill_func = nullptr;
     wrap->_getitem_func = nullptr;
     wrap->_setitem_func = nullptr;
   }
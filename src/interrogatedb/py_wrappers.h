@@ -21,16 +21,27 @@ struct Dtool_WrapperBase {
   const char *_name;
 };
 
+/**
+ * Stores new references to up to count items of the sequence, starting at the
+ * given index, into the given array.  Returns the number of items stored,
+ * which may be less than count if the end of the sequence is reached, or -1
+ * if an exception was raised.
+ */
+typedef Py_ssize_t (*Dtool_FillItemsFunc)(PyObject *self, PyObject **items,
+                                          Py_ssize_t start, Py_ssize_t count);
+
 struct Dtool_SequenceWrapper {
   Dtool_WrapperBase _base;
   lenfunc _len_func;
   ssizeargfunc _getitem_func;
+  Dtool_FillItemsFunc _fill_func;
 };
 
 struct Dtool_MutableSequenceWrapper {
   Dtool_WrapperBase _base;
   lenfunc _len_func;
   ssizeargfunc _getitem_func;
+  Dtool_FillItemsFunc _fill_func;
   ssizeobjargproc _setitem_func;
   PyObject *(*_insert_func)(PyObject *, size_t, PyObject *);
 };
@@ -21,6 +21,7 @@
 #include "preprocess_argv.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 using std::cerr;
 using std::cout;
@@ -515,6 +516,8 @@ usage() {
     "      synthesized functions like upcasts and downcasts.\n"
     "  -t  Give a detailed report of every type in the database, including types\n"
     "      like pointers and const pointers.\n"
+    "  -l  Load binary database files lazily, decoding each type and function\n"
+    "      only when it is reported.\n"
     "  -q  Quickly load up each shared library, if possible, and then immediately\n"
     "      exit.  Useful for quickly determining whether a library can even load.\n\n";
 }
@@ -523,7 +526,7 @@ int
 main(int argc, char **argv) {
   extern char *optarg;
   extern int optind;
-  const char *optstr = "p:ftqh";
+  const char *optstr = "p:ftlqh";
 
   bool all_functions = false;
   bool all_types = false;
@@ -545,6 +548,10 @@ main(int argc, char **argv) {
       all_types = true;
       break;
 
+    case 'l':
+      interrogate_set_lazy_loading(true);
+      break;
+
     case 'q':
       quick_load = true;
       break;
@@ -0,0 +1,41 @@
+// Exercises the replaying of cached tokens for manifests with parameters.
+
+#define MIN(a, b) (((int)a <= (int)b) ? (int)a : (int)b)
+#define TWICE(x) ((x) * 2)
+#define APPLY(f, x) f(x)
+#define FIRST(x, ...) x
+#define REST(x, ...) __VA_ARGS__
+#define STR(x) #x
+#define CONCAT(a, b) a##b
+#define TAIL(x) int x
+#define FOUR 4
+
+// CHECK: int a = (((int)(1) <= (int)(2)) ? (int)(1) : (int)(2))
+int a = MIN(1, 2);
+
+// CHECK: int b = (((int)((((int)(1) <= (int)(2)) ? (int)(1) : (int)(2))) <= (int)(3)) ? (int)((((int)(1) <= (int)(2)) ? (int)(1) : (int)(2))) : (int)(3))
+int b = MIN(MIN(1, 2), 3);
+
+// CHECK: int c = (4 * 2)
+int c = TWICE(FOUR);
+
+// CHECK: int d = (5 * 2)
+int d = APPLY(TWICE, 5);
+
+// CHECK: int e = 6
+int e = FIRST(6, 7, 8);
+
+// CHECK: int f = 7
+int f = REST(6, 7);
+
+// CHECK: char const *g = "a + b"
+const char *g = STR(a + b);
+
+// CHECK: int h = 9
+int CONCAT(h, ) = 9;
+
+// CHECK: char const *i = "x\"y"
+const char *i = FIRST("x\"y", 0);
+
+// CHECK: int j = (-1 * 2)
+TAIL(j) = TWICE(-1);
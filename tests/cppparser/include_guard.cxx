@@ -0,0 +1,56 @@
+// Exercises the skipping of files protected by an include guard.  Each file
+// below must be read again whenever it would produce different declarations.
+
+// Undefining the guard causes the file to be read again.  As long as it stays
+// defined, the file isn't even opened; include_guard_reads checks this by
+// counting how often each file is read.
+#define GUARDED_NAME GuardedFirst
+#include "include_guard/guarded.h"
+#undef GUARDED_NAME
+#undef INCLUDE_GUARD_GUARDED_H
+#define GUARDED_NAME GuardedSecond
+#include "include_guard/guarded.h"
+#include "include_guard/guarded.h"
+
+#define NOT_DEFINED_NAME NotDefinedFirst
+#include "include_guard/not_defined.h"
+#undef NOT_DEFINED_NAME
+#undef INCLUDE_GUARD_NOT_DEFINED_H
+#define NOT_DEFINED_NAME NotDefinedSecond
+#include "include_guard/not_defined.h"
+#include "include_guard/not_defined.h"
+
+// A guard with an #else clause does not cover the whole file.
+#include "include_guard/else.h"
+#include "include_guard/else.h"
+
+// Neither does a guard that is followed by other declarations.
+#define TRAILING_NAME TrailingFirst
+#include "include_guard/trailing.h"
+#undef TRAILING_NAME
+#define TRAILING_NAME TrailingSecond
+#include "include_guard/trailing.h"
+
+// CHECK: struct GuardedFirst { } guarded_first
+GuardedFirst guarded_first;
+
+// CHECK: struct GuardedSecond { } guarded_second
+GuardedSecond guarded_second;
+
+// CHECK: struct NotDefinedFirst { } not_defined_first
+NotDefinedFirst not_defined_first;
+
+// CHECK: struct NotDefinedSecond { } not_defined_second
+NotDefinedSecond not_defined_second;
+
+// CHECK: struct ElseFirst { } else_first
+ElseFirst else_first;
+
+// CHECK: struct ElseSecond { } else_second
+ElseSecond else_second;
+
+// CHECK: struct TrailingFirst { } trailing_first
+TrailingFirst trailing_first;
+
+// CHECK: struct TrailingSecond { } trailing_second
+TrailingSecond trailing_second;
@@ -0,0 +1,6 @@
+#ifndef INCLUDE_GUARD_ELSE_H
+#define INCLUDE_GUARD_ELSE_H
+struct ElseFirst {};
+#else
+struct ElseSecond {};
+#endif
@@ -0,0 +1,6 @@
+#ifndef INCLUDE_GUARD_GUARDED_H
+#define INCLUDE_GUARD_GUARDED_H
+
+struct GUARDED_NAME {};
+
+#endif
@@ -0,0 +1,6 @@
+#if !defined(INCLUDE_GUARD_NOT_DEFINED_H)
+#define INCLUDE_GUARD_NOT_DEFINED_H
+
+struct NOT_DEFINED_NAME {};
+
+#endif
@@ -0,0 +1,5 @@
+#ifndef INCLUDE_GUARD_TRAILING_H
+#define INCLUDE_GUARD_TRAILING_H
+#endif
+
+struct TRAILING_NAME {};
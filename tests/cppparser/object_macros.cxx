@@ -0,0 +1,41 @@
+// Exercises the replaying of cached tokens for manifests without parameters.
+
+#define EXPCL [[deprecated("for testing")]]
+#define INLINE inline
+#define NESTED EXPCL INLINE
+
+#define CALL TWICE
+#define TWICE(x) ((x) * 2)
+
+#define COMMA ,
+#define ANGLE >
+#define SHIFT (8 >> 2)
+
+template<class T, int N>
+class Pair {};
+
+int self_ref = 0;
+#define self_ref (self_ref + 1)
+
+#define ping pong
+#define pong ping
+
+class Foo {
+public:
+  NESTED void method();
+
+  Pair<int, 3 ANGLE p1;
+  Pair<int COMMA 3> p2;
+};
+
+// CHECK: int a = (::self_ref + 1)
+int a = self_ref;
+
+// CHECK: int ping = 0
+int ping = 0;
+
+// CHECK: int c = (3 * 2)
+int c = CALL(3);
+
+// CHECK: int d = (8 >> 2)
+int d = SHIFT;
@@ -0,0 +1,24 @@
+// A class backed by a vector of a simple numeric type exports its contents
+// via the buffer protocol, with the format character of the element type.
+
+namespace ns {
+template<class T>
+class vector {
+__published:
+  typedef T value_type;
+  vector();
+};
+}
+
+// CHECK: Dtool_GetBuffer_ns_vector_float\(PyObject[^"]*"f"\)
+typedef ns::vector<float> FloatArray;
+
+// CHECK: Dtool_GetBuffer_ns_vector_double\(PyObject[^"]*"d"\)
+typedef ns::vector<double> DoubleArray;
+
+// There is no format character for long double.
+// CHECK-NOT: Dtool_GetBuffer_ns_vector_long_double
+typedef ns::vector<long double> LongDoubleArray;
+
+// CHECK: Dtool_GetBuffer_ns_vector_int\(PyObject[^"]*"i"\)
+typedef ns::vector<int> IntArray;
@@ -0,0 +1,140 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file corrupt_db.cxx
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#include "dtoolbase.h"
+
+#include "interrogate_interface.h"
+#include "interrogate_request.h"
+
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::cerr;
+using std::string;
+
+// Queries every component that was added to the database since the counts
+// were last recorded, which forces any lazily loaded records to be decoded.
+static void
+query_new_components(int &num_types, int &num_functions, int &num_manifests,
+                     int &num_elements) {
+  int count = interrogate_number_of_types();
+  for (; num_types < count; ++num_types) {
+    TypeIndex type = interrogate_get_type(num_types);
+    interrogate_type_name(type);
+    interrogate_type_scoped_name(type);
+    int num_methods = interrogate_type_number_of_methods(type);
+    for (int i = 0; i < num_methods; ++i) {
+      interrogate_function_name(interrogate_type_get_method(type, i));
+    }
+    int num_derivations = interrogate_type_number_of_derivations(type);
+    for (int i = 0; i < num_derivations; ++i) {
+      interrogate_type_name(interrogate_type_get_derivation(type, i));
+    }
+  }
+
+  count = interrogate_number_of_functions();
+  for (; num_functions < count; ++num_functions) {
+    FunctionIndex function = interrogate_get_function(num_functions);
+    interrogate_function_name(function);
+    interrogate_function_prototype(function);
+    int num_wrappers = interrogate_function_number_of_python_wrappers(function);
+    for (int i = 0; i < num_wrappers; ++i) {
+      FunctionWrapperIndex wrapper =
+        interrogate_function_python_wrapper(function, i);
+      interrogate_wrapper_name(wrapper);
+      interrogate_wrapper_number_of_parameters(wrapper);
+      interrogate_get_wrapper_by_unique_name(
+        interrogate_wrapper_unique_name(wrapper));
+    }
+  }
+
+  count = interrogate_number_of_manifests();
+  for (; num_manifests < count; ++num_manifests) {
+    interrogate_manifest_name(interrogate_get_manifest(num_manifests));
+  }
+
+  count = interrogate_number_of_globals();
+  for (; num_elements < count; ++num_elements) {
+    interrogate_element_name(interrogate_get_global(num_elements));
+  }
+}
+
+/**
+ * Writes damaged copies of a binary interrogate database, truncated at
+ * various points and with random bytes overwritten, and requests each one,
+ * both with and without lazy loading.  Each damaged file must either be
+ * rejected or loaded without crashing.
+ */
+int
+main(int argc, char **argv) {
+  if (argc != 3) {
+    cerr << "Usage: corrupt_db database.in output_dir\n";
+    return 1;
+  }
+
+  std::ifstream in(argv[1], std::ios::in | std::ios::binary);
+  if (!in) {
+    cerr << "Unable to read " << argv[1] << "\n";
+    return 1;
+  }
+  std::ostringstream buffer;
+  buffer << in.rdbuf();
+  const string data = buffer.str();
+
+  std::vector<string> cases;
+  for (size_t n = 0; n < data.size(); n += 37) {
+    cases.push_back(data.substr(0, n));
+  }
+
+  // Use a fixed seed, so that a failure can be reproduced.
+  std::mt19937 random(1);
+  for (int i = 0; i < 300; ++i) {
+    string damaged = data;
+    int num_bytes = 1 + random() % 4;
+    for (int j = 0; j < num_bytes; ++j) {
+      damaged[random() % damaged.size()] = (char)(random() & 0xff);
+    }
+    cases.push_back(damaged);
+  }
+
+  int num_types = 0;
+  int num_functions = 0;
+  int num_manifests = 0;
+  int num_elements = 0;
+
+  // Every file gets its own name, since a lazily loaded database stays mapped
+  // after it is read.
+  for (size_t i = 0; i < cases.size() * 2; ++i) {
+    const string &contents = cases[i / 2];
+    std::ostringstream filename;
+    filename << argv[2] << "/corrupt_" << i << ".in";
+
+    std::ofstream out(filename.str(), std::ios::out | std::ios::binary);
+    out.write(contents.data(), contents.size());
+    out.close();
+    if (!out) {
+      cerr << "Unable to write " << filename.str() << "\n";
+      return 1;
+    }
+
+    interrogate_set_lazy_loading((i & 1) != 0);
+    interrogate_request_database(filename.str().c_str());
+    query_new_components(num_types, num_functions, num_manifests,
+                         num_elements);
+  }
+
+  return 0;
+}
@@ -0,0 +1,8 @@
+//FLAGS: -D__cplusplus -python-native
+#include "pch_common.h"
+
+class Derived : public Common {
+__published:
+  explicit Derived(int value = COMMON_VALUE);
+  Common *get_common();
+};
@@ -0,0 +1,21 @@
+#ifndef PCH_COMMON_H
+#define PCH_COMMON_H
+
+// PCH_WRITING is only defined when the precompiled header is made, so the
+// value differs if this file is read again when it is loaded.
+#ifdef PCH_WRITING
+#define COMMON_VALUE 42
+#else
+#define COMMON_VALUE 0
+#endif
+
+/**
+ * A class declared in the precompiled header.
+ */
+class Common {
+__published:
+  Common();
+  int get_value() const;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file pnotify.h
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#ifndef PNOTIFY_H
+#define PNOTIFY_H
+
+#include <string>
+
+// A stand-in for the assertion macros and the Notify class of Panda3D, which
+// the runtime code of -python-native modules expects to find.  Assertions are
+// checked, but don't report anything.
+
+#define nassertr(condition, return_value) \
+  do { if (!(condition)) { return return_value; } } while (0)
+#define nassertv(condition) \
+  do { if (!(condition)) { return; } } while (0)
+#define nassertd(condition) if (!(condition))
+#define nassertr_always(condition, return_value) nassertr(condition, return_value)
+#define nassertv_always(condition) nassertv(condition)
+
+class Notify {
+public:
+  static Notify *ptr() {
+    static Notify notify;
+    return &notify;
+  }
+
+  bool has_assert_failed() const { return false; }
+  const std::string &get_assert_error_message() const { return _message; }
+  void clear_assert_failed() {}
+
+private:
+  std::string _message;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file register_type.h
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#ifndef REGISTER_TYPE_H
+#define REGISTER_TYPE_H
+
+#include <Python.h>
+#include <vector>
+
+// A stand-in for the type registry of Panda3D, which the runtime code of
+// -python-native modules expects to find.  The classes in the tests don't
+// derive from TypedObject, so this only has to remember which Python type
+// goes with which handle.
+
+class TypeHandle {
+public:
+  static TypeHandle none() { return TypeHandle(0); }
+  static TypeHandle from_index(int index) { return TypeHandle(index); }
+
+  int get_index() const { return _index; }
+  PyObject *get_python_type() const;
+  PyObject *wrap_python(const void *) const { return nullptr; }
+  PyObject *wrap_python(void *, PyTypeObject *) const { return nullptr; }
+
+  bool operator == (const TypeHandle &other) const { return _index == other._index; }
+  bool operator != (const TypeHandle &other) const { return _index != other._index; }
+
+private:
+  explicit TypeHandle(int index) : _index(index) {}
+  int _index;
+};
+
+class TypeRegistry {
+public:
+  typedef void *PythonWrapFunc(void *, TypeHandle);
+
+  static TypeRegistry *ptr() {
+    static TypeRegistry registry;
+    return &registry;
+  }
+
+  TypeHandle register_dynamic_type(const char *) {
+    _types.push_back(nullptr);
+    return TypeHandle::from_index((int)_types.size() - 1);
+  }
+  void record_derivation(TypeHandle, TypeHandle) {}
+  void record_python_type(TypeHandle handle, PyObject *type) {
+    set_python_type(handle, type);
+  }
+  void record_python_type(TypeHandle handle, PyTypeObject *type, PythonWrapFunc *) {
+    set_python_type(handle, (PyObject *)type);
+  }
+
+  PyObject *get_python_type(TypeHandle handle) const {
+    size_t index = (size_t)handle.get_index();
+    return (index < _types.size()) ? _types[index] : nullptr;
+  }
+
+private:
+  void set_python_type(TypeHandle handle, PyObject *type) {
+    size_t index = (size_t)handle.get_index();
+    if (index >= _types.size()) {
+      _types.resize(index + 1, nullptr);
+    }
+    _types[index] = type;
+  }
+
+  std::vector<PyObject *> _types { nullptr };
+};
+
+inline PyObject *TypeHandle::
+get_python_type() const {
+  return TypeRegistry::ptr()->get_python_type(*this);
+}
+
+#define get_type_handle(type) (TypeHandle::none())
+
+#endif
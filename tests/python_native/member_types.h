@@ -0,0 +1,32 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file member_types.h
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#include "dtoolbase.h"
+
+/**
+ * A plain struct whose data members are accessed directly at their offset
+ * when the module is generated with -memberdefs.  test_member_types.py
+ * writes values to them from Python, and reads them back from C++.
+ */
+struct Members {
+PUBLISHED:
+  Members() = default;
+
+  float read_float() const { return float_value; }
+  double read_double() const { return double_value; }
+  int read_int() const { return int_value; }
+
+  float float_value = 0;
+  double double_value = 0;
+  int int_value = 0;
+};
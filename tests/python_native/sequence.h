@@ -0,0 +1,36 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file sequence.h
+ * @author agent
+ * @date 2026-10-17
+ */
+
+#include "dtoolbase.h"
+
+#include <vector>
+
+/**
+ * A list of integers that is exposed to Python as a sequence property, which
+ * test_sequence.py changes while iterating over it.
+ */
+class IntList {
+PUBLISHED:
+  IntList() = default;
+
+  void append(int value) { _values.push_back(value); }
+  void remove_front() { _values.erase(_values.begin()); }
+  void clear() { _values.clear(); }
+
+  size_t get_num_values() const { return _values.size(); }
+  int get_value(size_t n) const { return _values[n]; }
+  MAKE_SEQ_PROPERTY(values, get_num_values, get_value);
+
+private:
+  std::vector<int> _values;
+};
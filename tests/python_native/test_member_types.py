@@ -0,0 +1,43 @@
+# The data members of a plain struct are accessed directly at their offset,
+# with a type code that must match the C++ type of the member.
+
+import member_types
+
+
+def test_float():
+    m = member_types.Members()
+    m.float_value = 0.5
+    assert m.float_value == 0.5
+    assert m.read_float() == 0.5
+
+    # A float can't hold this exactly.
+    m.float_value = 0.1
+    assert m.float_value != 0.1
+    assert m.float_value == m.read_float()
+
+
+def test_double():
+    m = member_types.Members()
+    m.double_value = 0.1
+    assert m.double_value == 0.1
+    assert m.read_double() == 0.1
+
+    m.double_value = 1e300
+    assert m.double_value == 1e300
+    assert m.read_double() == 1e300
+
+
+def test_neighbours():
+    # Writing a member must not overwrite the members next to it.
+    m = member_types.Members()
+    m.int_value = 7
+    m.double_value = 2.5
+    m.float_value = 1.5
+    assert m.read_int() == 7
+    assert m.read_double() == 2.5
+    assert m.read_float() == 1.5
+
+
+test_float()
+test_double()
+test_neighbours()
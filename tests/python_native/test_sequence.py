@@ -0,0 +1,70 @@
+# Iterating over a sequence property fetches the items in chunks.  Changing
+# the sequence during the iteration must not yield items that were fetched
+# before the change.
+
+import sequence
+
+
+def make_list(count):
+    lst = sequence.IntList()
+    for i in range(count):
+        lst.append(i)
+    return lst
+
+
+def test_unchanged():
+    lst = make_list(40)
+    assert list(lst.values) == list(range(40))
+
+    it = iter(lst.values)
+    assert it.__length_hint__() == 40
+    next(it)
+    assert it.__length_hint__() == 39
+
+
+def iterate_and_shrink(values, remove_front):
+    seen = []
+    for value in values:
+        seen.append(value)
+        if value % 3 == 0:
+            remove_front()
+    return seen
+
+
+def test_shrink():
+    # Removing items from the front while iterating must not yield the removed
+    # items, which are still in the prefetched chunk.  The result should be
+    # the same as for a Python list.
+    expected_list = list(range(40))
+    expected = iterate_and_shrink(expected_list, lambda: expected_list.pop(0))
+
+    lst = make_list(40)
+    seen = iterate_and_shrink(lst.values, lst.remove_front)
+    assert seen == expected, (seen, expected)
+
+
+def test_clear():
+    # Emptying the sequence ends the iteration right away.
+    lst = make_list(40)
+    it = iter(lst.values)
+    assert next(it) == 0
+    lst.clear()
+    assert it.__length_hint__() == 0
+    assert list(it) == []
+
+
+def test_grow():
+    # Items appended during the iteration are visited as well.
+    lst = make_list(20)
+    seen = []
+    for value in lst.values:
+        seen.append(value)
+        if value < 20:
+            lst.append(value + 20)
+    assert seen == list(range(40)), seen
+
+
+test_unchanged()
+test_shrink()
+test_clear()
+test_grow()